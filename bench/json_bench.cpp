@@ -0,0 +1,157 @@
+/**
+ * @file json_bench.cpp
+ * @brief Microbenchmark: outbound IPC JSON encoding
+ *
+ * Compares the previous std::ostringstream + json_escape message building
+ * against host::JsonWriter writing into a reused buffer, for the two hot
+ * messages (motor telemetry and LCD text). Reports time and heap
+ * allocations per message.
+ *
+ * Build and run with `make bench` or the CMake `json_bench` target.
+ */
+
+#include "host/json_writer.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Count every heap allocation made by the process
+static std::atomic<uint64_t> allocations{0};
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// Previous implementation, kept verbatim for comparison
+static std::string json_escape(const std::string& s) {
+    std::string result;
+    for (char c : s) {
+        switch (c) {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default: result += c; break;
+        }
+    }
+    return result;
+}
+
+static std::string legacy_motor(uint8_t port, int32_t voltage, double velocity, double position) {
+    std::ostringstream ss;
+    ss << "{\"type\":\"motor\",\"port\":" << static_cast<int>(port)
+       << ",\"voltage\":" << voltage
+       << ",\"velocity\":" << velocity
+       << ",\"position\":" << position << "}";
+    return ss.str();
+}
+
+static std::string legacy_lcd(const std::vector<std::string>& lines) {
+    std::ostringstream ss;
+    ss << "{\"type\":\"lcd\",\"lines\":[";
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (i > 0) ss << ",";
+        ss << "\"" << json_escape(lines[i]) << "\"";
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+static void writer_motor(std::string& buffer, uint8_t port, int32_t voltage, double velocity, double position) {
+    buffer.clear();
+    host::JsonWriter json(buffer);
+    json.begin_object()
+        .key("type").value("motor")
+        .key("port").value(port)
+        .key("voltage").value(voltage)
+        .key("velocity").value(velocity)
+        .key("position").value(position)
+        .end_object();
+}
+
+static void writer_lcd(std::string& buffer, const std::vector<std::string>& lines) {
+    buffer.clear();
+    host::JsonWriter json(buffer);
+    json.begin_object().key("type").value("lcd").key("lines").begin_array();
+    for (const auto& line : lines) {
+        json.value(line);
+    }
+    json.end_array().end_object();
+}
+
+template <typename F>
+static void run(const char* name, int iterations, F&& body) {
+    // Warm up (and let reused buffers reach their final capacity)
+    for (int i = 0; i < 1000; i++) body(i);
+
+    uint64_t start_allocs = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) body(i);
+    auto end = std::chrono::steady_clock::now();
+    uint64_t allocs = allocations.load() - start_allocs;
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    std::printf("%-28s %9.1f ns/msg %8.2f allocs/msg\n", name, ns,
+                static_cast<double>(allocs) / iterations);
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    std::vector<std::string> lines = {
+        "VEX V5 Host Mode", "Ready!", "L:  127  R: -127", "Auto: \"Left 4-Ring\"",
+        "", "", "", ""
+    };
+
+    // Both paths must produce the same bytes
+    std::string check;
+    writer_motor(check, 3, -87, 123.456, 1500.5);
+    if (check != legacy_motor(3, -87, 123.456, 1500.5)) {
+        std::printf("motor output mismatch:\n  %s\n  %s\n", check.c_str(),
+                    legacy_motor(3, -87, 123.456, 1500.5).c_str());
+        return 1;
+    }
+    writer_lcd(check, lines);
+    if (check != legacy_lcd(lines)) {
+        std::printf("lcd output mismatch:\n  %s\n  %s\n", check.c_str(), legacy_lcd(lines).c_str());
+        return 1;
+    }
+
+    size_t sink = 0;
+    std::string buffer;
+
+    run("motor  ostringstream", iterations, [&](int i) {
+        sink += legacy_motor(static_cast<uint8_t>(i % 21 + 1), i % 255 - 127, i * 0.25, i * 1.5).size();
+    });
+    run("motor  JsonWriter", iterations, [&](int i) {
+        writer_motor(buffer, static_cast<uint8_t>(i % 21 + 1), i % 255 - 127, i * 0.25, i * 1.5);
+        sink += buffer.size();
+    });
+    run("lcd    ostringstream", iterations, [&](int) {
+        sink += legacy_lcd(lines).size();
+    });
+    run("lcd    JsonWriter", iterations, [&](int) {
+        writer_lcd(buffer, lines);
+        sink += buffer.size();
+    });
+
+    std::printf("(checksum %zu)\n", sink);
+    return 0;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file bounded_queue.hpp
+ * @brief Lock-free bounded queue for host mode IPC
+ *
+ * This header provides a fixed-capacity, lock-free queue (Dmitry Vyukov's
+ * bounded MPMC design) used to hand messages from any thread to the IPC
+ * writer thread without taking a lock.
+ */
+
+#ifndef HOST_BOUNDED_QUEUE_HPP
+#define HOST_BOUNDED_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace host {
+
+/**
+ * Bounded lock-free queue
+ *
+ * Any number of threads may push. The queue is normally drained by a single
+ * consumer, but pops are also safe from producers, which is how a full
+ * queue evicts its oldest entry for drop-oldest backpressure.
+ *
+ * @tparam T Element type (must be default-constructible and movable)
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * Creates a queue.
+     *
+     * @param capacity Maximum number of elements (rounded up to a power of two)
+     */
+    explicit BoundedQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        _mask = size - 1;
+        _cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        _enqueue_pos.store(0, std::memory_order_relaxed);
+        _dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * Attempts to push an element.
+     *
+     * @param value The element; moved from only on success
+     * @return True if pushed, false if the queue is full
+     */
+    bool try_push(T& value) {
+        Cell* cell;
+        size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &_cells[pos & _mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Attempts to pop the oldest element.
+     *
+     * @param value Receives the element on success
+     * @return True if an element was popped, false if the queue is empty
+     */
+    bool try_pop(T& value) {
+        Cell* cell;
+        size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &_cells[pos & _mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Checks whether the queue looks empty. Only a hint under concurrency.
+     *
+     * @return True if no elements were queued at the time of the call
+     */
+    bool empty() const {
+        return _enqueue_pos.load(std::memory_order_acquire) ==
+               _dequeue_pos.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    // Keep producer and consumer cursors on separate cache lines
+    alignas(64) std::unique_ptr<Cell[]> _cells;
+    size_t _mask;
+    alignas(64) std::atomic<size_t> _enqueue_pos;
+    alignas(64) std::atomic<size_t> _dequeue_pos;
+};
+
+} // namespace host
+
+#endif // HOST_BOUNDED_QUEUE_HPP
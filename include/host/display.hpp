@@ -10,11 +10,26 @@
 #define HOST_DISPLAY_HPP
 
 #include "liblvgl/lvgl.h"
+#include "host/ipc.hpp"
+#include "host/shared_framebuffer.hpp"
 #include <cstdint>
 #include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace host {
 
+/**
+ * How LVGL's rendering reaches the framebuffer
+ */
+enum class DisplayMode {
+    PARTIAL,      // Two 1/10-screen strip buffers, copied into the framebuffer as they are flushed
+    DIRECT,       // LVGL draws changed areas straight into the framebuffer; nothing is copied
+    FULL_REFRESH  // Two screen-sized pages, redrawn in full on any change and flipped on flush
+};
+
 /**
  * Display driver for host mode
  * 
@@ -39,8 +54,21 @@ public:
     /**
      * Initializes LVGL and the display driver.
      * Must be called before using LVGL functions.
+     *
+     * Partial mode draws the least per change; direct mode skips the copy
+     * from the draw buffer (lowest latency); full refresh always sends
+     * complete, never half-drawn frames at the cost of redrawing everything.
+     *
+     * @param mode How LVGL renders into the framebuffer
      */
-    void init();
+    void init(DisplayMode mode = DisplayMode::PARTIAL);
+
+    /**
+     * Gets the mode the display was initialized with.
+     *
+     * @return The display mode
+     */
+    DisplayMode get_mode();
 
     /**
      * Shuts down the display driver.
@@ -70,7 +98,46 @@ public:
     void update();
 
     /**
-     * Gets a pointer to the framebuffer.
+     * Sets the maximum rate at which screen updates are emitted.
+     * The effective rate never exceeds one frame per LV_DISP_DEF_REFR_PERIOD.
+     *
+     * @param fps Maximum frames per second (0 = one frame per refresh period)
+     */
+    void set_max_fps(uint32_t fps);
+
+    /**
+     * Requests that the next emitted frame be a full-screen keyframe.
+     * Called when a new viewer connects. Thread-safe.
+     */
+    void request_keyframe();
+
+    /**
+     * Sets how often a dirty frame is upgraded to a keyframe.
+     * Static screens never send periodic keyframes.
+     *
+     * @param interval_ms Keyframe interval in milliseconds (0 = only on request)
+     */
+    void set_keyframe_interval(uint32_t interval_ms);
+
+    /**
+     * Publishes frames through shared memory instead of sending pixels over
+     * IPC. The UI server is only sent a small notification per frame.
+     *
+     * @param name Shared-memory segment name (e.g. "/vex_screen")
+     * @return True if the segment was created
+     */
+    bool enable_shared_memory(const std::string& name);
+
+    /**
+     * Gets the current frame period used for emitting screen updates.
+     *
+     * @return Frame period in milliseconds
+     */
+    uint32_t get_frame_period();
+
+    /**
+     * Gets a pointer to the framebuffer (in full-refresh mode, the page
+     * flushed last).
      *
      * @return Pointer to the framebuffer (480x272 RGB565)
      */
@@ -83,6 +150,17 @@ public:
     static constexpr int HEIGHT = 272;
     static constexpr int BUFFER_SIZE = WIDTH * HEIGHT;
 
+    /**
+     * Maximum number of separate dirty rectangles tracked per frame.
+     * Beyond this, all dirty areas collapse into their bounding box.
+     */
+    static constexpr int MAX_DIRTY_RECTS = 16;
+
+    /**
+     * Default interval between periodic keyframes in milliseconds
+     */
+    static constexpr uint32_t DEFAULT_KEYFRAME_INTERVAL = 10000;
+
 private:
     Display();
     ~Display();
@@ -90,7 +168,11 @@ private:
     static void disp_flush_cb(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p);
     static void touch_read_cb(lv_indev_drv_t* drv, lv_indev_data_t* data);
 
+    void mark_dirty(const lv_area_t& area);
+    void emit_frame(bool keyframe);
+
     bool _initialized;
+    DisplayMode _mode;
     
     // Display driver
     lv_disp_draw_buf_t _draw_buf;
@@ -105,9 +187,35 @@ private:
     static lv_color_t _buf1[WIDTH * (HEIGHT / 10)];
     static lv_color_t _buf2[WIDTH * (HEIGHT / 10)];
     
-    // Full framebuffer for IPC
+    // Full framebuffer for IPC; in direct mode also LVGL's draw buffer, and in
+    // full-refresh mode the first of the two pages
     uint16_t _framebuffer[BUFFER_SIZE];
     
+    // Second full-refresh page (empty in the other modes)
+    std::vector<uint16_t> _back_page;
+    
+    // The complete frame the compositor sends: _framebuffer, or in
+    // full-refresh mode whichever page was flushed last
+    const uint16_t* _front;
+    
+    // Copy of what the UI has last been sent, used for delta encoding
+    uint16_t _shadow[BUFFER_SIZE];
+    
+    // Outgoing records, reused every frame so their buffers keep their capacity
+    std::vector<ScreenUpdate> _updates;
+    
+    // Frame compositor state (dirty areas accumulated between emitted frames)
+    lv_area_t _dirty[MAX_DIRTY_RECTS];
+    int _dirty_count;
+    uint32_t _frame_period_ms;
+    std::chrono::steady_clock::time_point _last_frame;
+    std::chrono::steady_clock::time_point _last_keyframe;
+    uint32_t _keyframe_interval_ms;
+    std::atomic<bool> _keyframe_requested;
+    
+    // Optional local transport; when open, pixels bypass the WebSocket
+    SharedFramebuffer _shared;
+    
     // Touch state
     std::atomic<int16_t> _touch_x;
     std::atomic<int16_t> _touch_y;
@@ -129,6 +237,16 @@ void lvgl_input_init();
  */
 void lvgl_update();
 
+/**
+ * Gets the recursive lock that guards all LVGL state (PROS keeps a similar
+ * LVGL mutex). Every lv_* function takes it and Display::update() holds it
+ * while rendering, so tasks may call LVGL from their own threads. Hold it
+ * to make a sequence of calls appear to the renderer all at once.
+ *
+ * @return The LVGL lock
+ */
+std::recursive_mutex& lvgl_mutex();
+
 } // namespace host
 
 #endif // HOST_DISPLAY_HPP
@@ -0,0 +1,268 @@
+/**
+ * @file fiber_scheduler.hpp
+ * @brief Cooperative task scheduler for host mode
+ *
+ * This header provides an optional backend for pros::Task that runs every
+ * task as a fiber (a stackful coroutine) on a single scheduler thread, the
+ * way FreeRTOS runs tasks on one core. Tasks switch only when they block
+ * (delay, wait, suspend, join), the highest-priority ready task always runs
+ * next and equal priorities take turns, so a run is reproducible.
+ */
+
+#ifndef HOST_FIBER_SCHEDULER_HPP
+#define HOST_FIBER_SCHEDULER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace host {
+
+class SimContext;
+struct FiberContext;
+
+/**
+ * Fiber lifecycle
+ */
+enum class FiberState {
+    READY,
+    RUNNING,
+    SLEEPING,    // Waiting for a deadline
+    BLOCKED,     // Waiting for wake(), optionally with a deadline
+    SUSPENDED,
+    FINISHED
+};
+
+/**
+ * One cooperative task. Owned by the scheduler; opaque to callers.
+ */
+struct Fiber {
+    std::function<void()> entry;
+    std::string name;
+    void* owner = nullptr;          // The pros::Task it runs
+    uint32_t priority = 0;
+    FiberState state = FiberState::READY;
+    uint64_t wake_us = 0;           // Deadline while SLEEPING or BLOCKED (0 = none)
+    uint64_t ready_seq = 0;         // FIFO order among equal priorities
+    uint64_t cpu_us = 0;            // CPU time used up to its last switch out
+    bool timed_out = false;         // Last block ended by its deadline
+    bool wake_pending = false;      // wake() arrived before block()
+    bool suspend_pending = false;   // Suspend once it next switches out
+    bool remove_pending = false;    // Remove once it next switches out
+    std::vector<Fiber*> joiners;    // Fibers waiting for this one to finish
+
+    // Stack and saved registers (platform-specific, so kept out of this header)
+    std::unique_ptr<FiberContext> context;
+
+    Fiber();
+    ~Fiber();
+};
+
+/**
+ * Cooperative scheduler, one per simulation context
+ *
+ * Scheduling state is guarded by one mutex, so any thread may create,
+ * suspend, resume, wake or reprioritize fibers; only the fiber itself may
+ * sleep, block or yield. The scheduler thread is a SimClock participant,
+ * and idles on the clock until the next deadline when no fiber is ready.
+ */
+class FiberScheduler {
+public:
+    /**
+     * Creates an idle scheduler; its thread starts with the first fiber.
+     *
+     * @param context The simulation context whose clock it runs on
+     */
+    explicit FiberScheduler(SimContext& context);
+    ~FiberScheduler();
+
+    FiberScheduler(const FiberScheduler&) = delete;
+    FiberScheduler& operator=(const FiberScheduler&) = delete;
+
+    /**
+     * Gets the scheduler whose fiber is running on the calling thread.
+     *
+     * @return The scheduler, or null when not called from a fiber
+     */
+    static FiberScheduler* current();
+
+    /**
+     * Selects fibers (true) or one OS thread per task (false) for tasks
+     * created from now on.
+     *
+     * @param enabled True to run tasks as fibers
+     */
+    void set_enabled(bool enabled) { _enabled = enabled; }
+
+    /**
+     * Checks if new tasks run as fibers.
+     *
+     * @return True if enabled
+     */
+    bool is_enabled() const { return _enabled; }
+
+    /**
+     * Creates a fiber. It does not run until start(), so the caller can
+     * store the handle first.
+     *
+     * @param entry The task body
+     * @param priority Higher runs first
+     * @param name Task name
+     * @param owner Caller's handle, stored in Fiber::owner
+     * @return The fiber (valid until release())
+     */
+    Fiber* create(std::function<void()> entry, uint32_t priority, const std::string& name,
+                  void* owner = nullptr);
+
+    /**
+     * Makes a new fiber ready, starting the scheduler thread if needed.
+     *
+     * @param fiber A fiber from create()
+     */
+    void start(Fiber* fiber);
+
+    /**
+     * Frees a finished fiber, or forgets one that never will finish.
+     *
+     * @param fiber The fiber
+     */
+    void release(Fiber* fiber);
+
+    /**
+     * Gets the fiber running on the calling thread.
+     *
+     * @return The fiber, or null
+     */
+    Fiber* running() const { return _running; }
+
+    /**
+     * Gets the CPU time used by the running fiber, including its current
+     * time slice.
+     *
+     * @return CPU time in microseconds
+     */
+    uint64_t running_cpu_us() const;
+
+    /**
+     * Sleeps the running fiber until a clock time.
+     *
+     * @param deadline_us Wake-up time in microseconds since program start
+     */
+    void sleep_until(uint64_t deadline_us);
+
+    /**
+     * Lets other ready fibers of the same or higher priority run.
+     */
+    void yield();
+
+    /**
+     * Blocks the running fiber until wake() or a deadline.
+     *
+     * @param deadline_us Deadline in microseconds, or 0 for none
+     * @return True if woken, false if the deadline passed
+     */
+    bool block(uint64_t deadline_us);
+
+    /**
+     * Makes a blocked fiber ready. Waking a fiber that is about to block
+     * makes that block() return at once.
+     *
+     * @param fiber The fiber
+     */
+    void wake(Fiber* fiber);
+
+    /**
+     * Suspends a fiber. Suspending the running fiber switches away at once.
+     *
+     * @param fiber The fiber
+     */
+    void suspend(Fiber* fiber);
+
+    /**
+     * Resumes a suspended fiber. A delay or block it was suspended in ends
+     * early, as in FreeRTOS.
+     *
+     * @param fiber The fiber
+     */
+    void resume(Fiber* fiber);
+
+    /**
+     * Ends a fiber without running the rest of it. Removing the running
+     * fiber does not return.
+     *
+     * @param fiber The fiber
+     */
+    void remove(Fiber* fiber);
+
+    /**
+     * Changes a fiber's priority.
+     *
+     * @param fiber The fiber
+     * @param priority The new priority
+     */
+    void set_priority(Fiber* fiber, uint32_t priority);
+
+    /**
+     * Waits until a fiber finishes, from a fiber or from any other thread.
+     *
+     * @param fiber The fiber
+     */
+    void join(Fiber* fiber);
+
+    /**
+     * Gets a fiber's state.
+     *
+     * @param fiber The fiber
+     * @return The state
+     */
+    FiberState state(Fiber* fiber);
+
+    // Default fiber stack size (host code needs far more than a V5 task);
+    // an overflow faults on a guard page below it
+    static constexpr size_t STACK_SIZE = 256 * 1024;
+
+private:
+    void run();
+    Fiber* pick_ready_locked();
+    void make_ready_locked(Fiber* fiber);
+    void finish_locked(Fiber* fiber);
+    void free_stack(Fiber* fiber);
+    bool on_fiber(Fiber* fiber) const;
+    void preempt_if_outranked(std::unique_lock<std::mutex>& lock);
+    void switch_to_scheduler(std::unique_lock<std::mutex>& lock);
+    void switch_to_fiber(Fiber* fiber, std::unique_lock<std::mutex>& lock);
+    static void fiber_main(Fiber* fiber);
+#ifdef _WIN32
+    static void __stdcall fiber_entry(void* param);
+#else
+    static void fiber_entry();
+#endif
+
+    SimContext& _context;
+    std::atomic<bool> _enabled;
+    std::mutex _mutex;
+    std::condition_variable _cv;       // Wakes the idle scheduler thread
+    std::condition_variable _finished; // Signals threads waiting in join()
+    std::list<std::unique_ptr<Fiber>> _fibers;
+    uint64_t _ready_seq;
+    bool _stop;
+    bool _started;
+    std::atomic<bool> _kick;           // A fiber became ready since the last pass
+    bool _idle;                        // Scheduler thread is asleep on the clock
+    std::thread _thread;
+
+    Fiber* _running;                   // Written by the scheduler thread under _mutex
+    uint64_t _switch_cpu_us;           // Thread CPU time when _running was switched in
+    std::unique_ptr<FiberContext> _scheduler_context;
+};
+
+} // namespace host
+
+#endif // HOST_FIBER_SCHEDULER_HPP
@@ -11,11 +11,16 @@
 
 #include <cstdint>
 #include <mutex>
+#include <atomic>
 #include <array>
 #include <string>
 #include <functional>
+#include <thread>
+#include <condition_variable>
 #include "pros/motors.hpp"
 #include "pros/controller.hpp"
+#include "host/seqlock.hpp"
+#include "host/motor_physics.hpp"
 
 namespace host {
 
@@ -52,7 +57,7 @@ struct ControllerState {
     bool connected = false;
     int32_t battery_capacity = 100;
     int32_t battery_level = 100;
-    std::array<std::string, 3> lcd_lines;          // Controller LCD
+    char lcd_lines[3][20] = {};                    // Controller LCD (3 x 19 chars)
 };
 
 /**
@@ -66,12 +71,27 @@ struct BatteryState {
 };
 
 /**
- * Hardware Abstraction Layer singleton
+ * Consistent copy of all device state
+ *
+ * Published once per physics step; every field comes from the same step.
+ */
+struct HALSnapshot {
+    uint32_t version = 0;                          // Increments with every published snapshot
+    std::array<MotorState, 21> motors;             // Index = port - 1
+    std::array<ControllerState, 2> controllers;
+    BatteryState battery;
+    RobotMode mode = RobotMode::DISABLED;
+};
+
+class SimContext;
+
+/**
+ * Hardware Abstraction Layer, one per simulation context
  */
 class HAL {
 public:
     /**
-     * Gets the singleton instance.
+     * Gets the HAL of the calling thread's simulation context.
      *
      * @return Reference to the HAL instance
      */
@@ -94,10 +114,41 @@ public:
     void shutdown();
 
     /**
-     * Updates the HAL state (called periodically).
+     * Advances the simulation by one fixed physics step and publishes the
+     * result. Called by the physics thread; call it directly only when the
+     * thread is not running.
      */
     void update();
 
+    /**
+     * Sets the physics step. Takes effect on the next step.
+     *
+     * @param step_ms Simulated time per step in milliseconds
+     * @param substeps Number of kernel iterations per step (finer integration,
+     *                 same publish rate)
+     */
+    void set_physics_step(double step_ms, int substeps);
+
+    /**
+     * Copies device configuration (motor commands, gearsets, connections and
+     * the physics step) from another HAL. Simulated motion starts from rest.
+     *
+     * @param other The HAL to copy from
+     */
+    void configure_from(HAL& other);
+
+    /**
+     * Starts the physics thread, which runs update() on a fixed-timestep
+     * accumulator driven by the wall clock, or once per step of virtual time
+     * when the SimClock is virtual.
+     */
+    void start_physics();
+
+    /**
+     * Stops the physics thread.
+     */
+    void stop_physics();
+
     // Motor functions
     void set_motor(uint8_t port, int32_t voltage);
     void set_motor_velocity(uint8_t port, int32_t velocity);
@@ -121,6 +172,17 @@ public:
     void set_controller_digital(pros::controller_id_e_t id, pros::controller_digital_e_t button, bool value);
     void set_controller_connected(pros::controller_id_e_t id, bool connected);
     
+    /**
+     * Replaces all analog and digital inputs of a controller at once, so
+     * readers never see half of an update.
+     *
+     * @param id The controller
+     * @param analog LX, LY, RX, RY
+     * @param digital Button states indexed by pros::controller_digital_e_t
+     */
+    void set_controller_inputs(pros::controller_id_e_t id, const std::array<int32_t, 4>& analog,
+                               const std::array<bool, 18>& digital);
+    
     int32_t get_controller_analog(pros::controller_id_e_t id, pros::controller_analog_e_t channel);
     bool get_controller_digital(pros::controller_id_e_t id, pros::controller_digital_e_t button);
     bool is_controller_connected(pros::controller_id_e_t id);
@@ -152,42 +214,101 @@ public:
     uint32_t lcd_get_background_color();
     uint32_t lcd_get_text_color();
 
-    // State access for IPC
-    const MotorState& get_motor_state(uint8_t port);
-    const ControllerState& get_controller_state(pros::controller_id_e_t id);
-    const BatteryState& get_battery_state();
+    /**
+     * Copies every motor, both controllers and the battery as of the last
+     * physics step in one lock-free read. Used by telemetry and logging.
+     *
+     * @param out Receives the snapshot
+     */
+    void get_snapshot(HALSnapshot& out);
 
     // Callback registration
     using StateCallback = std::function<void()>;
     void set_state_callback(StateCallback callback);
 
 private:
+    friend class SimContext;
     HAL();
     ~HAL();
 
-    std::mutex _mutex;
+    /**
+     * Motor port. Readers (user tasks, telemetry) never lock; writers
+     * (physics step, user setters) serialize on the port's own mutex.
+     */
+    struct MotorPort {
+        SeqLock<MotorState> state;
+        std::mutex write_mutex;
+        MotorState command;          // Newest state: user fields plus the last physics output
+        bool position_set = false;   // set_motor_position() not yet loaded into the lanes
+        double max_velocity = 0.0;      // Lane constants, kept current by refresh_limits()
+        double inv_max_velocity = 0.0;  // 0 while disconnected
+        
+        /** Recomputes the lane constants after a gearset or connection change (write_mutex held) */
+        void refresh_limits();
+    };
+    
+    /**
+     * Controller. Written by the IPC thread, double-buffered for readers.
+     */
+    struct ControllerPort {
+        DoubleBuffer<ControllerState> state;
+        std::mutex write_mutex;
+    };
+    
+    void publish_snapshot();
+    void physics_thread();
     
-    // Motor states (ports 1-21)
-    std::array<MotorState, 21> _motors;
+    void reset_motors(const std::array<MotorState, 21>& commands);
+    void gather_motor_lanes();
+    void scatter_motor_lanes();
+    
+    template <typename F>
+    void update_motor(uint8_t port, F&& modify);
+    template <typename F>
+    void update_controller(pros::controller_id_e_t id, F&& modify);
+    
+    // Motor states (ports 1-21). Physics runs on SoA lanes that only the
+    // stepping thread touches: each step gathers every port's commands
+    // under that port's lock, runs the kernel unlocked, then scatters the
+    // results back the same way
+    std::array<MotorPort, 21> _motors;
+    MotorLanes _motor_lanes;        // Guarded by _lanes_mutex
+    std::mutex _lanes_mutex;
+    
+    // Physics stepping
+    std::atomic<double> _physics_step_ms;
+    std::atomic<int> _physics_substeps;
+    std::thread _physics_thread;
+    std::atomic<bool> _physics_running;
+    std::mutex _physics_mutex;
+    std::condition_variable _physics_cv;
     
     // Controller states
-    std::array<ControllerState, 2> _controllers;
+    std::array<ControllerPort, 2> _controllers;
     
     // Battery state
-    BatteryState _battery;
+    SeqLock<BatteryState> _battery;
+    std::mutex _battery_mutex;
     
     // Competition state
-    RobotMode _robot_mode = RobotMode::DISABLED;
-    bool _competition_connected = false;
+    std::atomic<RobotMode> _robot_mode;
+    std::atomic<bool> _competition_connected;
     
-    // LCD state
+    // LCD state: text has its own lock, everything else is atomic
+    std::mutex _lcd_mutex;
     std::array<std::string, 8> _lcd_lines;
-    uint8_t _lcd_buttons = 0;
-    uint32_t _lcd_bg_color = 0x0000;  // Black
-    uint32_t _lcd_text_color = 0xFFFF; // White
-    bool _lcd_initialized = false;
+    std::atomic<uint8_t> _lcd_buttons;
+    std::atomic<uint32_t> _lcd_bg_color;
+    std::atomic<uint32_t> _lcd_text_color;
+    std::atomic<bool> _lcd_initialized;
+    
+    // Whole-device snapshot, republished after every physics step
+    DoubleBuffer<HALSnapshot> _snapshot;
+    HALSnapshot _staging;           // Guarded by _snapshot_mutex
+    std::mutex _snapshot_mutex;
     
     // Callback for state changes
+    std::mutex _callback_mutex;
     StateCallback _state_callback;
 };
 
@@ -11,12 +11,18 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <mutex>
+#include <condition_variable>
 #include <thread>
 #include <atomic>
 #include <functional>
-#include <queue>
+#include <map>
 #include <vector>
+#include "host/bounded_queue.hpp"
+#include "host/json_reader.hpp"
+#include "host/task_stats.hpp"
+#include "host/websocket.hpp"
 
 namespace host {
 
@@ -31,20 +37,88 @@ enum class IPCMessageType {
     AUTONS,          // Autonomous list
     LCD,             // LCD text update
     MODE,            // Current mode
+    TASKS,           // Task CPU and timing statistics
     
     // UI -> Host
     TOUCH,           // Touch input
     CONTROLLER,      // Controller input
     SET_MODE,        // Set robot mode
-    SELECT_AUTO      // Select autonomous
+    SELECT_AUTO,     // Select autonomous
+    KEYFRAME         // Request a full screen keyframe
 };
 
+/**
+ * Backpressure policy for outbound messages
+ */
+enum class SendPolicy {
+    LATEST,          // Screen frames: one message waits at a time, a newer one replaces it
+    RELIABLE         // Logs, mode, lists: never dropped, the caller waits for space
+};
+
+/**
+ * A queued outbound WebSocket message
+ *
+ * The first WS_MAX_CLIENT_HEADER bytes of the buffer are reserved: the writer
+ * fills in the frame header right in front of the payload and sends the
+ * whole frame from the one buffer.
+ */
+struct OutboundMessage {
+    uint8_t opcode = 0;       // WebSocket opcode (0x1 text, 0x2 binary)
+    bool keyframe = false;    // LATEST only: supersedes a pending message without a gap
+    std::string payload;      // Reserved header space + frame payload (binary-safe)
+};
+
+/**
+ * Screen payload encodings
+ */
+enum class ScreenEncoding : uint8_t {
+    RAW_RGB565 = 0,  // Row-major little-endian RGB565 covering the whole area
+    DELTA_SPANS = 1  // Changed spans against the previous frame (see below)
+};
+
+/**
+ * Screen record flags
+ */
+constexpr uint16_t SCREEN_FLAG_KEYFRAME = 0x0001;  // Full screen, resets the UI's copy
+
+/**
+ * Binary screen frame layout
+ *
+ * Screen updates are sent as binary WebSocket frames (opcode 0x2) instead of
+ * JSON. Each frame holds one or more records back to back; a record is a
+ * fixed little-endian header followed by its payload:
+ *
+ *   offset  size  field
+ *        0     1  magic ('S')
+ *        1     1  encoding (ScreenEncoding)
+ *        2     2  flags (reserved, 0)
+ *        4     4  sequence number
+ *        8     8  x1, y1, x2, y2 (int16 each, inclusive)
+ *       16     4  payload length in bytes
+ *       20     -  payload
+ *
+ * DELTA_SPANS payloads are a sequence of uint16 words walking the area in
+ * row-major order: [skip][count][count pixels]..., where `skip` pixels keep
+ * the value the UI already has and the next `count` pixels are replaced.
+ * Pixels past the last span are unchanged.
+ */
+constexpr uint8_t SCREEN_FRAME_MAGIC = 0x53;
+constexpr size_t SCREEN_HEADER_SIZE = 20;
+
 /**
  * Screen update data
  */
 struct ScreenUpdate {
     int32_t x1, y1, x2, y2;
-    std::vector<uint16_t> pixels;  // RGB565 data
+    ScreenEncoding encoding = ScreenEncoding::RAW_RGB565;
+    uint16_t flags = 0;
+    std::vector<uint16_t> pixels;  // RGB565 data, or encoded words for DELTA_SPANS
+    
+    // Raw updates may instead point at their top-left pixel in a larger
+    // image (`source_stride` pixels per row); the area is then copied from
+    // there straight into the outgoing frame and `pixels` is ignored
+    const uint16_t* source = nullptr;
+    int32_t source_stride = 0;
 };
 
 /**
@@ -110,6 +184,22 @@ public:
      */
     void send_screen_update(const ScreenUpdate& update);
 
+    /**
+     * Sends several screen updates as a single binary frame.
+     * All records share one sequence number.
+     *
+     * @param updates The screen updates making up one display frame
+     */
+    void send_screen_batch(const std::vector<ScreenUpdate>& updates);
+
+    /**
+     * Sends several screen updates as a single binary frame.
+     *
+     * @param updates The first screen update
+     * @param count Number of updates
+     */
+    void send_screen_batch(const ScreenUpdate* updates, size_t count);
+
     /**
      * Sends a full screen update to the UI.
      *
@@ -117,8 +207,21 @@ public:
      */
     void send_full_screen(const uint16_t* pixels);
 
+    /**
+     * Tells the UI that a new frame is in the shared-memory framebuffer.
+     * Notifications may be dropped under backpressure; readers catch up
+     * from the frame counter.
+     *
+     * @param name Shared-memory segment name
+     * @param frame Frame counter after publishing
+     * @param keyframe Whether the whole screen was marked dirty
+     */
+    void send_screen_notify(const std::string& name, uint64_t frame, bool keyframe);
+
     /**
      * Sends motor telemetry to the UI.
+     * Coalesced per port: only the newest value is sent at each telemetry
+     * flush, and values identical to the last one sent are skipped.
      *
      * @param port The motor port (1-21)
      * @param voltage The motor voltage
@@ -146,11 +249,21 @@ public:
 
     /**
      * Sends LCD text to the UI.
+     * Coalesced like motor telemetry; safe to call every loop.
      *
      * @param lines The LCD lines (0-7)
      */
     void send_lcd_update(const std::vector<std::string>& lines);
 
+    /**
+     * Sends per-task CPU and timing statistics to the UI.
+     * Coalesced like motor telemetry.
+     *
+     * @param time_ms Simulation time of the snapshot, for CPU percentages
+     * @param tasks The tasks' counters
+     */
+    void send_task_stats(uint32_t time_ms, const std::vector<TaskStats>& tasks);
+
     /**
      * Sends the current robot mode to the UI.
      *
@@ -158,6 +271,39 @@ public:
      */
     void send_mode(const std::string& mode);
 
+    /**
+     * Sets how often coalesced telemetry (motor, LCD) is flushed.
+     * Only the newest value per motor port / LCD is sent at each flush,
+     * so bandwidth is bounded no matter how often user code updates.
+     *
+     * @param hz Flush rate in Hz (default 50)
+     */
+    void set_telemetry_rate(uint32_t hz);
+
+    /**
+     * Gets the number of screen messages replaced before they were sent.
+     *
+     * @return Dropped message count since startup
+     */
+    uint64_t get_dropped_count();
+
+    /**
+     * Checks whether a screen message is still waiting for the writer.
+     * The display holds its dirty areas back until it has gone, so a slow
+     * connection gets fewer, larger frames instead of dropped ones.
+     *
+     * @return True if a screen message is pending
+     */
+    bool screen_pending();
+
+    /**
+     * Checks and clears whether a screen frame was dropped since the last call.
+     * The UI is then out of sync with delta updates and needs a keyframe.
+     *
+     * @return True if a screen frame was dropped
+     */
+    bool consume_screen_drop();
+
     /**
      * Processes incoming messages.
      */
@@ -168,35 +314,86 @@ public:
     using ControllerCallback = std::function<void(const ControllerInput&)>;
     using ModeCallback = std::function<void(const std::string&)>;
     using AutoSelectCallback = std::function<void(const std::string&, int)>;
+    using KeyframeCallback = std::function<void()>;
 
     void set_touch_callback(TouchCallback callback);
     void set_controller_callback(ControllerCallback callback);
     void set_mode_callback(ModeCallback callback);
     void set_auto_select_callback(AutoSelectCallback callback);
+    void set_keyframe_callback(KeyframeCallback callback);
 
 private:
     IPCClient();
     ~IPCClient();
 
+    bool handshake(const std::string& host, uint16_t port);
     void receive_thread();
-    void send_message(const std::string& json);
-    void parse_message(const std::string& json);
+    bool process_frames();
+    void writer_thread();
+    std::string acquire_buffer();
+    std::string acquire_screen_buffer(size_t size);
+    void release_buffer(std::string&& buffer);
+    void send_message(std::string json, SendPolicy policy = SendPolicy::RELIABLE);
+    void send_close(uint16_t code);
+    void enqueue(OutboundMessage&& message, SendPolicy policy);
+    void wake_writer();
+    bool take_latest(OutboundMessage& message);
+    bool write_frame(OutboundMessage& message);
+    void send_latest(IPCMessageType type, uint32_t key, std::string json);
+    bool flush_slots();
+    void invalidate_slots();
+    void parse_message(std::string_view json);
 
     std::atomic<bool> _connected;
     std::atomic<bool> _running;
     
     int _socket_fd;
     std::thread _receive_thread;
+    std::thread _writer_thread;
+    
+    WebSocketParser _parser;        // Receive thread only (after the handshake)
+    JsonReader _json_reader;        // Receive thread only
+    uint64_t _mask_state;           // Writer thread only: masking key generator
     
-    std::mutex _send_mutex;
     std::mutex _callback_mutex;
     
-    std::queue<std::string> _send_queue;
+    // Outbound pipeline: producers never touch the socket, the writer thread does
+    BoundedQueue<OutboundMessage> _reliable_queue;
+    std::mutex _writer_mutex;
+    std::condition_variable _writer_cv;
+    std::condition_variable _space_cv;      // Reliable producers waiting for queue space
+    std::atomic<bool> _writer_waiting;
+    std::atomic<uint32_t> _space_waiters;
+    std::atomic<uint16_t> _close_code;      // Close frame to send once drained (0: none)
+    
+    // Latest screen message (depth one, replaced rather than queued)
+    std::mutex _latest_mutex;
+    OutboundMessage _latest;
+    std::atomic<bool> _latest_pending;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<bool> _screen_dropped;
+    BoundedQueue<std::string> _buffer_pool;  // Recycled message buffers
+    BoundedQueue<std::string> _screen_pool;  // Recycled (large) screen frame buffers
+    
+    // Latest-value-wins slots, one per (message type, key)
+    struct Slot {
+        std::string pending;      // Newest unsent value
+        std::string last_sent;    // Skips re-sending unchanged values
+        bool dirty = false;
+    };
+    std::mutex _slot_mutex;
+    std::map<uint32_t, Slot> _slots;
+    std::atomic<bool> _slots_pending;
+    std::atomic<uint32_t> _flush_interval_ms;
+    std::vector<OutboundMessage> _flush_batch;  // Writer thread only
+    
+    std::atomic<uint32_t> _screen_seq;
     
     TouchCallback _touch_callback;
     ControllerCallback _controller_callback;
     ModeCallback _mode_callback;
     AutoSelectCallback _auto_select_callback;
+    KeyframeCallback _keyframe_callback;
 };
 
 } // namespace host
@@ -0,0 +1,78 @@
+/**
+ * @file json_reader.hpp
+ * @brief Event-based JSON parser for host mode IPC
+ *
+ * This header provides a single-pass, allocation-free JSON parser. Instead of
+ * building a document it reports what it sees (keys, values, nesting) to a
+ * handler, which keeps only the fields it cares about.
+ */
+
+#ifndef HOST_JSON_READER_HPP
+#define HOST_JSON_READER_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace host {
+
+/**
+ * Receives parse events from JsonReader
+ *
+ * String views passed to key() and string_value() are only valid during the
+ * call; copy anything that must outlive it.
+ */
+class JsonHandler {
+public:
+    virtual ~JsonHandler() = default;
+
+    virtual void begin_object() {}
+    virtual void end_object() {}
+    virtual void begin_array() {}
+    virtual void end_array() {}
+    virtual void key(std::string_view name) { (void)name; }
+    virtual void string_value(std::string_view value) { (void)value; }
+    virtual void number_value(double value) { (void)value; }
+    virtual void bool_value(bool value) { (void)value; }
+    virtual void null_value() {}
+};
+
+/**
+ * Single-pass JSON parser
+ *
+ * Strings without escapes are passed as views into the input; escaped
+ * strings are decoded into a fixed internal buffer, so parsing never
+ * allocates. Not thread-safe: use one reader per thread.
+ */
+class JsonReader {
+public:
+    /**
+     * Parses a complete JSON value.
+     *
+     * @param json The input text
+     * @param handler Receives the parse events
+     * @return True if the input was valid JSON (events may already have
+     *         been delivered for a prefix of invalid input)
+     */
+    bool parse(std::string_view json, JsonHandler& handler);
+
+    // Limits that keep parsing bounded without allocating
+    static constexpr size_t MAX_DEPTH = 32;
+    static constexpr size_t MAX_ESCAPED_STRING = 512;
+
+private:
+    bool parse_value(JsonHandler& handler, size_t depth);
+    bool parse_object(JsonHandler& handler, size_t depth);
+    bool parse_array(JsonHandler& handler, size_t depth);
+    bool parse_string(std::string_view& out);
+    bool parse_number(double& out);
+    bool parse_literal(const char* literal);
+    void skip_whitespace();
+
+    const char* _pos = nullptr;
+    const char* _end = nullptr;
+    char _scratch[MAX_ESCAPED_STRING];
+};
+
+} // namespace host
+
+#endif // HOST_JSON_READER_HPP
@@ -0,0 +1,86 @@
+/**
+ * @file json_writer.hpp
+ * @brief Streaming JSON writer for host mode IPC
+ *
+ * This header provides a small JSON writer that appends straight into a
+ * caller-owned byte buffer. Numbers are formatted with std::to_chars and
+ * strings are escaped in place, so encoding a message into a buffer with
+ * enough capacity performs no allocation at all.
+ */
+
+#ifndef HOST_JSON_WRITER_HPP
+#define HOST_JSON_WRITER_HPP
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace host {
+
+/**
+ * Streaming JSON writer
+ *
+ * Commas and colons are inserted automatically:
+ *
+ *     JsonWriter json(buffer);
+ *     json.begin_object().key("type").value("motor").key("port").value(1).end_object();
+ *
+ * Output is appended to the buffer, so a buffer may start with reserved bytes
+ * (such as space for a WebSocket frame header).
+ */
+class JsonWriter {
+public:
+    /**
+     * Creates a writer appending to a buffer.
+     *
+     * @param out The output buffer
+     */
+    explicit JsonWriter(std::string& out) : _out(out), _first(0), _depth(0), _after_key(false) {}
+
+    JsonWriter& begin_object();
+    JsonWriter& end_object();
+    JsonWriter& begin_array();
+    JsonWriter& end_array();
+
+    /**
+     * Writes an object key. The next value belongs to it.
+     *
+     * @param name The key (escaped like any string)
+     */
+    JsonWriter& key(const char* name);
+
+    JsonWriter& value(const char* s);
+    JsonWriter& value(const std::string& s);
+    JsonWriter& value(bool b);
+
+    /**
+     * Writes a floating point number with 6 significant digits (the same
+     * output std::ostream gives by default). NaN and infinity become null.
+     */
+    JsonWriter& value(double d);
+
+    /**
+     * Writes any integer type.
+     */
+    template <typename T,
+              typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    JsonWriter& value(T v) {
+        return value_integer(static_cast<int64_t>(v));
+    }
+
+private:
+    JsonWriter& value_integer(int64_t v);
+    void separator();
+    void push();
+    void pop();
+    void write_string(const char* s, size_t len);
+
+    std::string& _out;
+    uint32_t _first;     // Bit per nesting level: no element written yet
+    uint32_t _depth;
+    bool _after_key;
+};
+
+} // namespace host
+
+#endif // HOST_JSON_WRITER_HPP
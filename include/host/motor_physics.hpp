@@ -0,0 +1,63 @@
+/**
+ * @file motor_physics.hpp
+ * @brief Batched motor physics for host mode
+ *
+ * This header provides the motor model as structure-of-arrays lanes and a
+ * kernel that steps every port at once. Each quantity is a contiguous,
+ * aligned array and the step has no per-port branches, so the compiler can
+ * vectorize it.
+ */
+
+#ifndef HOST_MOTOR_PHYSICS_HPP
+#define HOST_MOTOR_PHYSICS_HPP
+
+#include <cstddef>
+#include "pros/motors.hpp"
+
+namespace host {
+
+/**
+ * Motor state for all ports, one lane per port
+ *
+ * Lanes past the last port are padding so the step runs in whole vectors;
+ * they stay inactive. Inactive lanes (disconnected motors) keep their
+ * values across steps.
+ */
+struct MotorLanes {
+    static constexpr size_t PORTS = 21;
+    static constexpr size_t LANES = 24;  // PORTS rounded up to a multiple of 8
+
+    // Inputs, set from the user commands
+    alignas(64) double voltage[LANES] = {};           // -127 to 127
+    alignas(64) double max_velocity[LANES] = {};      // RPM at full voltage
+    alignas(64) double inv_max_velocity[LANES] = {};  // 1 / max_velocity (0 if inactive)
+    alignas(64) double active[LANES] = {};            // 1.0 if connected, else 0.0
+
+    // Simulated outputs
+    alignas(64) double velocity[LANES] = {};          // Actual velocity (RPM)
+    alignas(64) double position[LANES] = {};          // Degrees
+    alignas(64) double current[LANES] = {};           // mA
+    alignas(64) double temperature[LANES] = {};       // Celsius
+
+    MotorLanes();
+};
+
+/**
+ * Gets the free speed of a gearset.
+ *
+ * @param gearset The gearset
+ * @return Maximum velocity in RPM
+ */
+double motor_max_velocity(pros::motor_gearset_e_t gearset);
+
+/**
+ * Advances every active lane by one step.
+ *
+ * @param lanes The motor lanes
+ * @param dt_ms Step length in milliseconds
+ */
+void step_motors(MotorLanes& lanes, double dt_ms);
+
+} // namespace host
+
+#endif // HOST_MOTOR_PHYSICS_HPP
@@ -0,0 +1,103 @@
+/**
+ * @file pixel_ops.hpp
+ * @brief Vectorized RGB565 pixel kernels for host mode drawing
+ *
+ * This header provides the pixel primitives the renderer and display driver
+ * are built on: solid fill, alpha blend, rectangular copy and RGB565 to
+ * RGBA8888 expansion. Each kernel has SSE2, AVX2 and NEON versions next to a
+ * scalar fallback; the best one the CPU supports is picked on first use.
+ * Every version produces bit-identical output.
+ */
+
+#ifndef HOST_PIXEL_OPS_HPP
+#define HOST_PIXEL_OPS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace host {
+
+/**
+ * Instruction set used by the pixel kernels
+ */
+enum class PixelIsa {
+    SCALAR,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+/**
+ * Gets the instruction set the kernels currently run on.
+ */
+PixelIsa pixel_isa();
+
+/**
+ * Checks whether this build and CPU can run an instruction set.
+ *
+ * @param isa The instruction set
+ * @return true if set_pixel_isa() would accept it
+ */
+bool pixel_isa_supported(PixelIsa isa);
+
+/**
+ * Forces the kernels onto an instruction set (for benchmarks and comparing
+ * output). Not thread-safe against kernels running at the same time.
+ *
+ * @param isa The instruction set
+ * @return false (and no change) if it is not supported
+ */
+bool set_pixel_isa(PixelIsa isa);
+
+/**
+ * Gets a printable name for an instruction set ("scalar", "sse2", ...).
+ */
+const char* pixel_isa_name(PixelIsa isa);
+
+/**
+ * Sets a run of pixels to one color.
+ *
+ * @param dst The first pixel
+ * @param color The RGB565 color
+ * @param count Number of pixels
+ */
+void pixel_fill(uint16_t* dst, uint16_t color, size_t count);
+
+/**
+ * Blends one color over a run of pixels:
+ * dst = (color * opa + dst * (255 - opa)) / 255 per channel.
+ *
+ * @param dst The first pixel
+ * @param color The RGB565 color
+ * @param opa Opacity, 0 (transparent) to 255 (cover)
+ * @param count Number of pixels
+ */
+void pixel_blend(uint16_t* dst, uint16_t color, uint8_t opa, size_t count);
+
+/**
+ * Copies a rectangle of pixels. Strides are in pixels.
+ *
+ * @param dst Top-left destination pixel
+ * @param dst_stride Pixels from one destination row to the next
+ * @param src Top-left source pixel
+ * @param src_stride Pixels from one source row to the next
+ * @param width Rectangle width
+ * @param height Rectangle height
+ */
+void pixel_copy(uint16_t* dst, size_t dst_stride, const uint16_t* src, size_t src_stride,
+                size_t width, size_t height);
+
+/**
+ * Expands RGB565 pixels to RGBA8888 (bytes R, G, B, A in memory, alpha 255),
+ * the layout of a canvas ImageData. Channels are shifted up without
+ * rounding, matching the browser UI.
+ *
+ * @param dst Output pixels
+ * @param src Input pixels
+ * @param count Number of pixels
+ */
+void pixel_to_rgba8888(uint32_t* dst, const uint16_t* src, size_t count);
+
+} // namespace host
+
+#endif // HOST_PIXEL_OPS_HPP
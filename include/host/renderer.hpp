@@ -0,0 +1,33 @@
+/**
+ * @file renderer.hpp
+ * @brief Software renderer for the host-mode LVGL object tree
+ *
+ * This header provides the refresh step behind lv_timer_handler(). Objects
+ * invalidate the screen areas they cover when they change; a refresh redraws
+ * only those areas, strip by strip, into the display's draw buffer and hands
+ * each strip to the driver's flush callback. A screen with nothing
+ * invalidated costs nothing to refresh.
+ *
+ * Drivers with `direct_mode` set have a screen-sized buffer that areas are
+ * drawn into in place; drivers with `full_refresh` set get the whole screen
+ * redrawn and flushed at once whenever anything changed. Both flip between
+ * buf1 and buf2 after a refresh when there are two buffers.
+ */
+
+#ifndef HOST_RENDERER_HPP
+#define HOST_RENDERER_HPP
+
+#include "liblvgl/lvgl.h"
+
+namespace host {
+
+/**
+ * Redraws every invalidated area of a display and clears the list.
+ *
+ * @param disp The display (its driver must have a draw buffer and flush_cb)
+ */
+void render_invalidated(lv_disp_t* disp);
+
+} // namespace host
+
+#endif // HOST_RENDERER_HPP
@@ -0,0 +1,166 @@
+/**
+ * @file seqlock.hpp
+ * @brief Lock-free publication primitives for host mode state
+ *
+ * This header provides a sequence lock and a double buffer built on it.
+ * Both let one writer at a time publish a small trivially copyable value
+ * while any number of readers take consistent copies without locking.
+ */
+
+#ifndef HOST_SEQLOCK_HPP
+#define HOST_SEQLOCK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace host {
+
+/**
+ * Sequence lock
+ *
+ * The value is stored as relaxed atomic words, so concurrent reads and
+ * writes are well defined; the sequence number tells a reader whether the
+ * copy it took was torn. Writers must be serialized by the caller.
+ *
+ * @tparam T Value type (must be trivially copyable)
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock() : _seq(0) {
+        store(T());
+    }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    /**
+     * Takes a consistent copy of the value. Never blocks the writer.
+     *
+     * @return The value
+     */
+    T load() const {
+        T value;
+        load(value);
+        return value;
+    }
+
+    /**
+     * Copies the value into caller-owned storage (avoids a second copy for
+     * large values).
+     *
+     * @param out Receives the value
+     */
+    void load(T& out) const {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&out);
+        while (true) {
+            uint32_t before = _seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (size_t i = 0; i < WORDS; i++) {
+                uint64_t word = _words[i].load(std::memory_order_relaxed);
+                size_t offset = i * sizeof(uint64_t);
+                size_t len = sizeof(T) - offset < sizeof(uint64_t) ? sizeof(T) - offset : sizeof(uint64_t);
+                memcpy(bytes + offset, &word, len);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_seq.load(std::memory_order_relaxed) == before) return;
+        }
+    }
+
+    /**
+     * Publishes a new value.
+     *
+     * @param value The value
+     */
+    void store(const T& value) {
+        uint64_t words[WORDS] = {};
+        memcpy(words, &value, sizeof(T));
+
+        uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++) {
+            _words[i].store(words[i], std::memory_order_relaxed);
+        }
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> _seq;
+    std::atomic<uint64_t> _words[WORDS];
+};
+
+/**
+ * Double-buffered value
+ *
+ * The writer fills the slot readers are not using and then flips to it, so
+ * a reader only has to retry if the writer laps it twice mid-copy. Suited to
+ * larger values read far more often than they are written. Writers must be
+ * serialized by the caller.
+ *
+ * @tparam T Value type (must be trivially copyable)
+ */
+template <typename T>
+class DoubleBuffer {
+public:
+    DoubleBuffer() : _current(0) {}
+
+    DoubleBuffer(const DoubleBuffer&) = delete;
+    DoubleBuffer& operator=(const DoubleBuffer&) = delete;
+
+    /**
+     * Takes a consistent copy of the newest value.
+     *
+     * @return The value
+     */
+    T load() const {
+        return _slots[_current.load(std::memory_order_acquire) & 1].load();
+    }
+
+    /**
+     * Copies the newest value into caller-owned storage.
+     *
+     * @param out Receives the value
+     */
+    void load(T& out) const {
+        _slots[_current.load(std::memory_order_acquire) & 1].load(out);
+    }
+
+    /**
+     * Publishes a new value.
+     *
+     * @param value The value
+     */
+    void store(const T& value) {
+        uint32_t next = _current.load(std::memory_order_relaxed) + 1;
+        _slots[next & 1].store(value);
+        _current.store(next, std::memory_order_release);
+    }
+
+    /**
+     * Gets the number of values published so far.
+     *
+     * @return The version counter
+     */
+    uint32_t version() const {
+        return _current.load(std::memory_order_acquire);
+    }
+
+private:
+    SeqLock<T> _slots[2];
+    std::atomic<uint32_t> _current;
+};
+
+} // namespace host
+
+#endif // HOST_SEQLOCK_HPP
@@ -0,0 +1,145 @@
+/**
+ * @file shared_framebuffer.hpp
+ * @brief Shared-memory screen transport for host mode
+ *
+ * This header provides an optional transport that publishes the display
+ * framebuffer into a POSIX shared-memory segment, so a viewer on the same
+ * machine can read frames without them passing through the WebSocket.
+ */
+
+#ifndef HOST_SHARED_FRAMEBUFFER_HPP
+#define HOST_SHARED_FRAMEBUFFER_HPP
+
+#include "liblvgl/lvgl.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace host {
+
+/**
+ * Shared-memory segment layout (all fields little-endian)
+ *
+ *   offset  size  field
+ *   0       4     magic        SHM_MAGIC ("VXFB")
+ *   4       4     version      SHM_VERSION
+ *   8       2     width
+ *   10      2     height
+ *   12      4     seq          Seqlock: odd while the writer updates the header
+ *   16      4     front        Buffer (0 or 1) holding the newest complete frame
+ *   20      4     tile_size    Dirty bitmap granularity in pixels
+ *   24      8     frame        Frame counter, +1 per published frame
+ *   32      2     tiles_x
+ *   34      2     tiles_y
+ *   36      4     buffer_offset  Offset of buffer 0 (buffer 1 follows it)
+ *   40      4     buffer_size    Bytes per buffer (width * height * 2, RGB565)
+ *   44      20    reserved
+ *   64      64    dirty        Bitmap of tiles changed since frame - 1: tile
+ *                              (tx, ty) is bit (ty * tiles_x + tx), LSB first
+ *
+ * Reading a frame: read seq (retry while odd), read front/frame/dirty, copy
+ * what is needed from the front buffer, then re-read seq and retry if it
+ * changed. The writer only ever draws into the other buffer, so a reader has
+ * a whole frame period before the buffer it is reading gets reused. If frame
+ * advanced by more than one since the last read, treat every tile as dirty.
+ */
+constexpr uint32_t SHM_MAGIC = 0x42465856;  // "VXFB"
+constexpr uint32_t SHM_VERSION = 1;
+constexpr uint32_t SHM_TILE_SIZE = 16;
+constexpr size_t SHM_BITMAP_OFFSET = 64;
+constexpr size_t SHM_BITMAP_SIZE = 64;
+constexpr size_t SHM_BUFFER_OFFSET = 4096;
+
+struct SharedFramebufferHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint16_t width;
+    uint16_t height;
+    std::atomic<uint32_t> seq;
+    std::atomic<uint32_t> front;
+    uint32_t tile_size;
+    uint64_t frame;
+    uint16_t tiles_x;
+    uint16_t tiles_y;
+    uint32_t buffer_offset;
+    uint32_t buffer_size;
+    uint8_t reserved[20];
+    uint8_t dirty[SHM_BITMAP_SIZE];
+};
+
+/**
+ * Writer side of the shared-memory screen transport
+ *
+ * Publishing copies only the areas that changed into the back buffer, then
+ * flips buffers under the seqlock. Only available on POSIX systems.
+ */
+class SharedFramebuffer {
+public:
+    SharedFramebuffer();
+    ~SharedFramebuffer();
+
+    SharedFramebuffer(const SharedFramebuffer&) = delete;
+    SharedFramebuffer& operator=(const SharedFramebuffer&) = delete;
+
+    /**
+     * Creates (or replaces) the shared-memory segment.
+     *
+     * @param name Segment name, e.g. "/vex_screen" (appears as /dev/shm/vex_screen on Linux)
+     * @param width Screen width in pixels
+     * @param height Screen height in pixels
+     * @return True if the segment is ready
+     */
+    bool open(const std::string& name, int width, int height);
+
+    /**
+     * Unmaps and unlinks the segment.
+     */
+    void close();
+
+    /**
+     * Checks if the segment is open.
+     *
+     * @return True if open
+     */
+    bool is_open() const { return _header != nullptr; }
+
+    /**
+     * Gets the segment name.
+     *
+     * @return The name passed to open()
+     */
+    const std::string& name() const { return _name; }
+
+    /**
+     * Publishes a frame.
+     *
+     * @param framebuffer The full framebuffer (width * height RGB565)
+     * @param dirty Areas changed since the last publish
+     * @param count Number of dirty areas
+     * @param full Mark every tile dirty (and copy the whole frame)
+     * @return The new frame counter
+     */
+    uint64_t publish(const uint16_t* framebuffer, const lv_area_t* dirty, int count, bool full);
+
+private:
+    static constexpr int MAX_AREAS = 32;
+
+    void copy_area(const uint16_t* framebuffer, uint16_t* dst, const lv_area_t& area);
+
+    std::string _name;
+    int _width;
+    int _height;
+    size_t _size;
+    SharedFramebufferHeader* _header;
+    uint16_t* _buffers[2];
+
+    // Areas written to the front buffer last time; the back buffer lacks them
+    lv_area_t _prev_dirty[MAX_AREAS];
+    int _prev_count;
+    bool _prev_full;
+};
+
+} // namespace host
+
+#endif // HOST_SHARED_FRAMEBUFFER_HPP
@@ -0,0 +1,224 @@
+/**
+ * @file sim_clock.hpp
+ * @brief Simulation time source for host mode
+ *
+ * This header provides the clock behind pros::delay, pros::millis,
+ * Task::delay_until, Clock::now and the physics step. By default it follows
+ * the wall clock. In virtual mode time only moves when every participating
+ * thread is asleep, and then jumps straight to the earliest wake-up, so
+ * simulated routines run as fast as the host can execute them.
+ */
+
+#ifndef HOST_SIM_CLOCK_HPP
+#define HOST_SIM_CLOCK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+namespace host {
+
+class SimContext;
+
+/**
+ * Simulation clock
+ *
+ * Participants are the threads that drive the simulation (user tasks, the
+ * competition mode thread, physics, the main loop). Virtual time advances
+ * only while all of them are blocked in sleep_until(). Other threads may
+ * sleep on the clock too; they wake when time reaches their deadline but
+ * never hold it back.
+ */
+class SimClock {
+public:
+    /**
+     * Gets the clock of the calling thread's simulation context.
+     *
+     * @return Reference to the SimClock instance
+     */
+    static SimClock& instance();
+
+    SimClock(const SimClock&) = delete;
+    SimClock& operator=(const SimClock&) = delete;
+
+    /**
+     * Switches between wall-clock and virtual time. Call before any
+     * participant starts; virtual time starts at 0.
+     *
+     * @param enabled True for virtual time
+     */
+    void set_virtual(bool enabled);
+
+    /**
+     * Checks if the clock runs on virtual time.
+     *
+     * @return True if virtual
+     */
+    bool is_virtual() const { return _virtual; }
+
+    /**
+     * Sets how much of each wall-clock sleep is spent busy-waiting. The
+     * thread sleeps until that long before its deadline, then spins, which
+     * trades CPU for wakeups accurate to a few microseconds. No effect on
+     * virtual time.
+     *
+     * @param spin_us Spin phase in microseconds (0 = sleep the whole way)
+     */
+    void set_spin(uint32_t spin_us) { _spin_us = spin_us; }
+
+    /**
+     * Gets the spin phase of wall-clock sleeps.
+     *
+     * @return Spin phase in microseconds
+     */
+    uint32_t get_spin() const { return _spin_us; }
+
+    /**
+     * Gets the time since program start.
+     *
+     * @return Time in microseconds
+     */
+    uint64_t now_us() const;
+
+    /**
+     * Gets the time since program start.
+     *
+     * @return Time in milliseconds
+     */
+    uint32_t now_ms() const { return static_cast<uint32_t>(now_us() / 1000); }
+
+    /**
+     * Blocks the calling thread until the clock reaches a time.
+     *
+     * @param deadline_us Wake-up time in microseconds since program start
+     */
+    void sleep_until(uint64_t deadline_us);
+
+    /**
+     * Blocks the calling thread until the clock reaches a time or another
+     * thread sets a flag and calls interrupt().
+     *
+     * @param deadline_us Wake-up time in microseconds since program start
+     * @param wake Flag that ends the sleep early once set
+     */
+    void sleep_until(uint64_t deadline_us, const std::atomic<bool>& wake);
+
+    /**
+     * Wakes sleepers whose wake flag was set.
+     */
+    void interrupt();
+
+    /**
+     * Blocks the calling thread for a duration of clock time.
+     *
+     * @param duration_us Duration in microseconds
+     */
+    void sleep_for(uint64_t duration_us) { sleep_until(now_us() + duration_us); }
+
+    /**
+     * Counts a thread that is about to be started as a participant, so time
+     * cannot advance before it gets to run. The new thread must then call
+     * attach_reserved().
+     */
+    void reserve();
+
+    /**
+     * Makes the calling thread a participant, consuming a reserve().
+     */
+    void attach_reserved();
+
+    /**
+     * Makes the calling thread a participant.
+     */
+    void attach();
+
+    /**
+     * Removes the calling thread from the participants.
+     */
+    void detach();
+
+    /**
+     * Checks if the calling thread is a participant.
+     *
+     * @return True if attached
+     */
+    bool is_attached() const;
+
+    /**
+     * Stops virtual time for good; sleepers never wake again.
+     */
+    void halt();
+
+    /**
+     * Keeps the calling thread a participant for the lifetime of the guard.
+     */
+    class Participant {
+    public:
+        Participant() { SimClock::instance().attach(); }
+        ~Participant() { SimClock::instance().detach(); }
+        Participant(const Participant&) = delete;
+        Participant& operator=(const Participant&) = delete;
+    };
+
+    /**
+     * Takes the calling thread out of the participants while it blocks on
+     * something other than the clock (such as joining a thread), so virtual
+     * time can still advance. Restores it when the guard goes away.
+     */
+    class BlockingScope {
+    public:
+        BlockingScope() : _clock(SimClock::instance()), _attached(_clock.is_attached()) {
+            if (_attached) _clock.detach();
+        }
+        ~BlockingScope() {
+            if (_attached) _clock.attach();
+        }
+        BlockingScope(const BlockingScope&) = delete;
+        BlockingScope& operator=(const BlockingScope&) = delete;
+
+    private:
+        SimClock& _clock;
+        bool _attached;
+    };
+
+private:
+    friend class SimContext;
+    SimClock();
+
+    // A thread blocked in sleep_until(). Whoever wakes it removes the entry
+    // and counts it awake at once, so time cannot jump again before it runs
+    struct Sleeper {
+        bool participant;
+        const std::atomic<bool>* wake;  // Ends the sleep early (null = none)
+        bool* removed;                  // Set when the entry is taken out
+    };
+
+    // Jumps to the earliest deadline if every participant is asleep
+    // (caller holds _mutex)
+    void advance_locked();
+
+    // Takes a sleeper's entry out and counts it awake (caller holds _mutex)
+    void remove_sleeper_locked(std::multimap<uint64_t, Sleeper>::iterator entry);
+
+    // Busy-waits from now until a wall-clock deadline, or until wake is set
+    void spin_until(std::chrono::steady_clock::time_point deadline, const std::atomic<bool>* wake) const;
+
+    std::chrono::steady_clock::time_point _start;
+    std::atomic<uint32_t> _spin_us;
+    std::atomic<bool> _virtual;
+    std::atomic<uint64_t> _virtual_us;
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    int _participants;              // Guarded by _mutex
+    int _sleeping;                  // Participants blocked in sleep_until
+    bool _halted;
+    std::multimap<uint64_t, Sleeper> _deadlines;
+};
+
+} // namespace host
+
+#endif // HOST_SIM_CLOCK_HPP
@@ -0,0 +1,118 @@
+/**
+ * @file sim_context.hpp
+ * @brief Simulation contexts for host mode
+ *
+ * This header provides SimContext, which owns the state of one simulated
+ * robot (its clock, HAL and task scheduler). HAL::instance() and SimClock::instance() return
+ * the calling thread's context, so several robots can be simulated in one
+ * process, each on its own threads.
+ */
+
+#ifndef HOST_SIM_CONTEXT_HPP
+#define HOST_SIM_CONTEXT_HPP
+
+#include "host/sim_clock.hpp"
+#include "host/hal.hpp"
+#include "host/fiber_scheduler.hpp"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace host {
+
+/**
+ * State of one simulated robot
+ *
+ * Every thread belongs to one context: the primary context unless it was
+ * bound to another with a Scope. pros::Task threads and the physics thread
+ * inherit the context of the thread that started them.
+ *
+ * Per context: the clock, the HAL (devices and physics), the fiber
+ * scheduler and the tasks started from it. Shared by the whole process and
+ * owned by the primary context: the display and LVGL, the IPC client and
+ * the autonomous selector. Other contexts simulate hardware and time only;
+ * LVGL object calls from one do nothing. A new context starts with no
+ * tasks, so tasks started in the primary context do not follow code into it.
+ */
+class SimContext {
+public:
+    /**
+     * Creates a context with a fresh clock (wall-clock time) and HAL.
+     */
+    SimContext();
+    ~SimContext() = default;
+
+    SimContext(const SimContext&) = delete;
+    SimContext& operator=(const SimContext&) = delete;
+
+    /**
+     * Gets the calling thread's context.
+     *
+     * @return The bound context, or the primary context
+     */
+    static SimContext& current();
+
+    /**
+     * Gets the process-wide default context (the interactive robot).
+     *
+     * @return The primary context
+     */
+    static SimContext& primary();
+
+    SimClock& clock() { return _clock; }
+    HAL& hal() { return _hal; }
+    FiberScheduler& scheduler() { return _scheduler; }
+
+    /**
+     * Freezes the context for good: virtual time stops, so any thread still
+     * running in it blocks at its next sleep. Used when a routine overruns
+     * and cannot be stopped; an abandoned context is leaked rather than
+     * destroyed under its live threads.
+     */
+    void abandon();
+
+    /**
+     * Checks if the context was abandoned.
+     *
+     * @return True if abandoned
+     */
+    bool is_abandoned() const { return _abandoned; }
+
+    /**
+     * Binds a context to the calling thread for the lifetime of the guard.
+     */
+    class Scope {
+    public:
+        explicit Scope(SimContext& context);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        SimContext* _previous;
+    };
+
+    /**
+     * Runs jobs on a pool of worker threads, each in a fresh context on
+     * virtual time that starts with the primary context's device
+     * configuration and task backend. The worker is a clock participant
+     * while its job runs.
+     *
+     * @param count Number of jobs
+     * @param workers Number of worker threads (0 = one per hardware thread)
+     * @param job Called with the job index; its context is current
+     */
+    static void run_parallel(size_t count, size_t workers, const std::function<void(size_t)>& job);
+
+private:
+    // Declaration order matters: the HAL's physics thread and the scheduler
+    // use the clock, and tasks use the HAL
+    SimClock _clock;
+    HAL _hal;
+    FiberScheduler _scheduler;
+    std::atomic<bool> _abandoned;
+};
+
+} // namespace host
+
+#endif // HOST_SIM_CONTEXT_HPP
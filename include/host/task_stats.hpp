@@ -0,0 +1,184 @@
+/**
+ * @file task_stats.hpp
+ * @brief Per-task CPU and timing instrumentation for host mode
+ *
+ * This header provides TaskMonitor, which records how much CPU a task uses,
+ * how late it wakes from delays and how steady its delay_until() loop
+ * period is. Every pros::Task has one, as does the competition mode thread;
+ * the counters are published lock-free so the UI can read them while the
+ * task runs.
+ */
+
+#ifndef HOST_TASK_STATS_HPP
+#define HOST_TASK_STATS_HPP
+
+#include "host/seqlock.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace host {
+
+class SimContext;
+
+// Wakeup lateness histogram: bucket i counts wakeups later than the
+// previous bound and up to LATENESS_BOUNDS_US[i]; the last bucket counts
+// everything later than the final bound
+constexpr size_t LATENESS_BUCKETS = 8;
+constexpr uint32_t LATENESS_BOUNDS_US[LATENESS_BUCKETS - 1] = {10, 100, 500, 1000, 2000, 5000, 10000};
+
+/**
+ * Counters for one task (trivially copyable, published through a SeqLock)
+ */
+struct TaskTiming {
+    uint64_t cpu_us;                       // CPU time used by the task
+    uint32_t wakeups;                      // Delays completed
+    uint32_t lateness[LATENESS_BUCKETS];   // Wakeup lateness histogram
+    uint64_t lateness_total_us;
+    uint64_t lateness_max_us;
+    uint32_t periods;                      // delay_until() periods measured
+    uint32_t overruns;                     // delay_until() calls already past their deadline
+    uint64_t jitter_total_us;              // Sum of |period - expected period|
+    uint64_t jitter_max_us;
+    uint64_t last_period_us;               // Most recent delay_until() period
+};
+
+/**
+ * A snapshot of one task's counters
+ */
+struct TaskStats {
+    uint32_t id;                           // Unique per monitor for the life of the process
+    std::string name;
+    uint32_t priority;
+    TaskTiming timing;
+};
+
+/**
+ * Gets the CPU time used by the calling thread (CLOCK_THREAD_CPUTIME_ID, or
+ * GetThreadTimes on Windows).
+ *
+ * @return CPU time in microseconds
+ */
+uint64_t thread_cpu_time_us();
+
+/**
+ * Instrumentation for one task
+ *
+ * Only the task itself records into its monitor; any thread may read it.
+ * Monitors register themselves with the calling thread's simulation
+ * context for the lifetime of the object.
+ */
+class TaskMonitor {
+public:
+    /**
+     * Creates and registers a monitor.
+     *
+     * @param name Task name
+     * @param priority Task priority
+     */
+    TaskMonitor(const std::string& name, uint32_t priority);
+    ~TaskMonitor();
+
+    TaskMonitor(const TaskMonitor&) = delete;
+    TaskMonitor& operator=(const TaskMonitor&) = delete;
+
+    /**
+     * Updates the reported priority.
+     *
+     * @param priority The new priority
+     */
+    void set_priority(uint32_t priority) { _priority = priority; }
+
+    /**
+     * Records a wakeup from a delay.
+     *
+     * @param target_us Time the task asked to wake at
+     * @param woke_us Time it actually resumed
+     * @param cpu_us CPU time the task has used so far
+     */
+    void record_wakeup(uint64_t target_us, uint64_t woke_us, uint64_t cpu_us);
+
+    /**
+     * Records a wakeup from delay_until(), which also measures the loop
+     * period against the previous one.
+     *
+     * @param target_us Time the task asked to wake at
+     * @param woke_us Time it actually resumed
+     * @param period_us Period the loop asked for
+     * @param cpu_us CPU time the task has used so far
+     * @param overran True if the deadline had passed before the call
+     */
+    void record_period(uint64_t target_us, uint64_t woke_us, uint64_t period_us, uint64_t cpu_us,
+                       bool overran);
+
+    /**
+     * Records CPU time without a wakeup (such as when the task ends).
+     *
+     * @param cpu_us CPU time the task has used so far
+     */
+    void record_cpu(uint64_t cpu_us);
+
+    /**
+     * Takes a consistent copy of the counters.
+     *
+     * @param stats Receives the name, priority and counters
+     */
+    void get_stats(TaskStats& stats) const;
+
+    /**
+     * Gets the monitor bound to the calling thread.
+     *
+     * @return The monitor, or null
+     */
+    static TaskMonitor* bound();
+
+    /**
+     * Gets the CPU time the calling thread has used since its monitor was
+     * bound.
+     *
+     * @return CPU time in microseconds
+     */
+    static uint64_t bound_cpu_us();
+
+    /**
+     * Binds a monitor to the calling thread for the lifetime of the guard.
+     * Tasks running as fibers are looked up through their pros::Task
+     * instead, since they share a thread.
+     */
+    class Scope {
+    public:
+        explicit Scope(TaskMonitor& monitor);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        TaskMonitor* _previous;
+        uint64_t _previous_cpu_start;
+    };
+
+    /**
+     * Collects the counters of every task in a simulation context.
+     *
+     * @param context The context
+     * @param out Receives one entry per task (reuses its storage)
+     */
+    static void collect(SimContext& context, std::vector<TaskStats>& out);
+
+private:
+    void publish();
+
+    uint32_t _id;
+    std::string _name;
+    std::atomic<uint32_t> _priority;
+    SimContext* _context;
+    TaskTiming _timing;                // Writer's copy
+    uint64_t _last_wake_us;            // Previous delay_until() wakeup (0 = none)
+    SeqLock<TaskTiming> _published;
+};
+
+} // namespace host
+
+#endif // HOST_TASK_STATS_HPP
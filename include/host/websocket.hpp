@@ -0,0 +1,181 @@
+/**
+ * @file websocket.hpp
+ * @brief RFC 6455 WebSocket protocol helpers for host mode IPC
+ *
+ * This header provides the pieces of the WebSocket protocol the IPC client
+ * needs: the opening handshake, client-side payload masking and a streaming
+ * frame parser that reassembles fragmented messages out of a ring buffer.
+ */
+
+#ifndef HOST_WEBSOCKET_HPP
+#define HOST_WEBSOCKET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace host {
+
+/**
+ * WebSocket frame opcodes
+ */
+enum WebSocketOpcode : uint8_t {
+    WS_OPCODE_CONTINUATION = 0x0,
+    WS_OPCODE_TEXT = 0x1,
+    WS_OPCODE_BINARY = 0x2,
+    WS_OPCODE_CLOSE = 0x8,
+    WS_OPCODE_PING = 0x9,
+    WS_OPCODE_PONG = 0xA
+};
+
+/**
+ * WebSocket close status codes used by the client
+ */
+constexpr uint16_t WS_CLOSE_NORMAL = 1000;
+constexpr uint16_t WS_CLOSE_PROTOCOL_ERROR = 1002;
+constexpr uint16_t WS_CLOSE_TOO_BIG = 1009;
+
+/**
+ * Largest client frame header: 2 bytes + 64-bit length + 4-byte masking key
+ */
+constexpr size_t WS_MAX_CLIENT_HEADER = 14;
+
+/**
+ * Builds the HTTP upgrade request for the opening handshake.
+ *
+ * @param host The server host (for the Host header)
+ * @param port The server port
+ * @param path The request path
+ * @param key Receives the random Sec-WebSocket-Key that was used
+ * @return The complete request, ready to send
+ */
+std::string websocket_handshake_request(const std::string& host, uint16_t port,
+                                        const std::string& path, std::string& key);
+
+/**
+ * Validates the server's handshake response.
+ *
+ * @param response The response headers (up to and including the blank line)
+ * @param key The Sec-WebSocket-Key sent with the request
+ * @return True if the server switched protocols with the expected accept key
+ */
+bool websocket_handshake_valid(const std::string& response, const std::string& key);
+
+/**
+ * XORs a payload with a frame masking key.
+ * Works on 8 bytes at a time; the same call masks and unmasks.
+ *
+ * @param data The payload bytes, modified in place
+ * @param len Number of bytes
+ * @param key The 4-byte masking key
+ * @param offset Position of data[0] within the frame payload, so a payload
+ *               can be processed in several chunks
+ */
+void websocket_mask(uint8_t* data, size_t len, const uint8_t key[4], size_t offset = 0);
+
+/**
+ * Streaming WebSocket frame parser
+ *
+ * Bytes are received straight into an internal ring buffer, then next() is
+ * called until it returns NEED_MORE. Frame payloads are streamed out of the
+ * ring as they arrive, so messages larger than the ring are fine. Fragmented
+ * data messages are reassembled; control frames may be interleaved with
+ * fragments as the RFC allows. All buffers are reused between messages.
+ */
+class WebSocketParser {
+public:
+    enum class Result {
+        NEED_MORE,       // Feed more bytes
+        MESSAGE,         // message() holds a complete text or binary message
+        PING,            // control_payload() holds the ping payload
+        PONG,            // control_payload() holds the pong payload
+        CLOSE,           // close_code() holds the peer's status code
+        PROTOCOL_ERROR   // Protocol violation; error_code() holds the close code to send
+    };
+
+    /**
+     * Creates a parser.
+     *
+     * @param ring_capacity Receive ring size in bytes (rounded up to a power of two)
+     * @param max_message Largest reassembled message accepted
+     */
+    explicit WebSocketParser(size_t ring_capacity = 16384, size_t max_message = 1 << 20);
+
+    /**
+     * Discards all buffered state, e.g. for a new connection.
+     */
+    void reset();
+
+    /**
+     * Gets contiguous free space to receive into.
+     *
+     * @param available Receives the number of writable bytes
+     * @return Pointer to the free space
+     */
+    uint8_t* write_ptr(size_t& available);
+
+    /**
+     * Marks bytes written at write_ptr() as received.
+     *
+     * @param len Number of bytes written
+     */
+    void commit(size_t len);
+
+    /**
+     * Copies bytes into the ring (for data read outside write_ptr()).
+     *
+     * @param data The bytes
+     * @param len Number of bytes
+     * @return Number of bytes accepted
+     */
+    size_t feed(const uint8_t* data, size_t len);
+
+    /**
+     * Parses buffered bytes up to the next event.
+     *
+     * @return The event, or NEED_MORE once the buffer is drained
+     */
+    Result next();
+
+    const std::string& message() const { return _message; }
+    uint8_t message_opcode() const { return _message_opcode; }
+    const std::string& control_payload() const { return _control; }
+    uint16_t close_code() const { return _close_code; }
+    uint16_t error_code() const { return _error_code; }
+
+private:
+    enum class State { HEADER, PAYLOAD };
+
+    size_t buffered() const { return _write_pos - _read_pos; }
+    uint8_t peek(size_t offset) const { return _ring[(_read_pos + offset) & _mask]; }
+    void consume_into(std::string& out, size_t len);
+    Result fail(uint16_t code);
+
+    std::unique_ptr<uint8_t[]> _ring;
+    size_t _mask;
+    size_t _read_pos;
+    size_t _write_pos;
+    size_t _max_message;
+
+    // Current frame
+    State _state;
+    uint8_t _opcode;
+    bool _fin;
+    bool _masked;
+    uint8_t _mask_key[4];
+    uint64_t _remaining;
+    uint64_t _payload_offset;
+
+    // Reassembly
+    std::string _message;
+    uint8_t _message_opcode;
+    bool _in_fragment;
+    std::string _control;
+    uint16_t _close_code;
+    uint16_t _error_code;
+};
+
+} // namespace host
+
+#endif // HOST_WEBSOCKET_HPP
@@ -102,22 +102,48 @@ typedef struct _lv_group_t lv_group_t;
 struct _lv_event_t;
 typedef struct _lv_event_t lv_event_t;
 
-/* Style type - simplified */
+/* Style type - simplified: an array of property/value pairs */
 typedef struct {
     void* values;
     uint16_t prop_cnt;
 } lv_style_t;
 
+/* Style property value */
+typedef union {
+    int32_t num;
+    const void* ptr;
+    lv_color_t color;
+} lv_style_value_t;
+
+/* Widget class - simplified to an identity used for type checks and theming */
+typedef struct _lv_obj_class_t {
+    const struct _lv_obj_class_t* base_class;
+    const char* name;
+} lv_obj_class_t;
+
+/* Object data kept outside lv_obj_t (children, styles, event callbacks) */
+typedef struct _lv_obj_spec_attr_t lv_obj_spec_attr_t;
+
 /* Object structure - simplified */
 struct _lv_obj_t {
     struct _lv_obj_t* parent;
-    lv_area_t coords;
+    lv_area_t coords;   /* Relative to the parent; x2/y2 are x1/y1 plus the size */
     void* user_data;
     lv_style_t* styles;
     uint32_t state;
     uint32_t flags;
+    const lv_obj_class_t* class_p;
+    lv_obj_spec_attr_t* spec_attr;
 };
 
+/* Widget classes */
+extern const lv_obj_class_t lv_obj_class;
+extern const lv_obj_class_t lv_btn_class;
+extern const lv_obj_class_t lv_label_class;
+extern const lv_obj_class_t lv_bar_class;
+extern const lv_obj_class_t lv_btnmatrix_class;
+extern const lv_obj_class_t lv_tabview_class;
+
 /* Font type - simplified */
 typedef struct {
     uint8_t line_height;
@@ -165,6 +191,9 @@ struct _lv_disp_drv_t {
     void* user_data;
 };
 
+/* Number of separate invalidated areas kept before the whole screen is redrawn */
+#define LV_INV_BUF_SIZE 32
+
 /* Display structure */
 struct _lv_disp_t {
     lv_disp_drv_t* driver;
@@ -172,6 +201,8 @@ struct _lv_disp_t {
     lv_obj_t* prev_scr;
     lv_obj_t* scr_to_load;
     uint32_t last_activity_time;
+    lv_area_t inv_areas[LV_INV_BUF_SIZE];   /* Areas to redraw on the next refresh */
+    uint16_t inv_p;
 };
 
 /* Display driver functions */
@@ -179,6 +210,9 @@ void lv_disp_draw_buf_init(lv_disp_draw_buf_t* draw_buf, void* buf1, void* buf2,
 void lv_disp_drv_init(lv_disp_drv_t* driver);
 lv_disp_t* lv_disp_drv_register(lv_disp_drv_t* driver);
 void lv_disp_flush_ready(lv_disp_drv_t* disp_drv);
+bool lv_disp_flush_is_last(lv_disp_drv_t* disp_drv);
+lv_disp_t* lv_disp_get_default(void);
+void _lv_inv_area(lv_disp_t* disp, const lv_area_t* area_p);
 
 /*====================
  * INPUT DEVICE DRIVER
@@ -316,6 +350,24 @@ lv_obj_t* lv_scr_act(void);
 void lv_scr_load(lv_obj_t* scr);
 void lv_scr_load_anim(lv_obj_t* scr, int anim_type, uint32_t time, uint32_t delay, bool auto_del);
 
+/*====================
+ * MEMORY
+ *====================*/
+
+/* Memory usage, measured against the LV_MEM_SIZE budget */
+typedef struct {
+    uint32_t total_size;        /* LV_MEM_SIZE */
+    uint32_t free_cnt;          /* Object slots allocated but unused */
+    uint32_t free_size;
+    uint32_t free_biggest_size;
+    uint32_t used_cnt;          /* Live objects */
+    uint32_t max_used;          /* Most bytes ever in use */
+    uint8_t used_pct;
+    uint8_t frag_pct;
+} lv_mem_monitor_t;
+
+void lv_mem_monitor(lv_mem_monitor_t* mon_p);
+
 /*====================
  * OBJECT FUNCTIONS
  *====================*/
@@ -422,12 +474,19 @@ typedef enum {
 
 /* Size special values */
 #define LV_SIZE_CONTENT 0x7FFF
+#define LV_RADIUS_CIRCLE 0x7FFF
+#define LV_COORD_MAX ((1 << 13) - 1)
 #define LV_PCT(x) (((x) < 0 ? 0x8001 : 0x8000) | ((x) < 0 ? -(x) : (x)))
 
 /* Object creation/deletion */
 lv_obj_t* lv_obj_create(lv_obj_t* parent);
 void lv_obj_del(lv_obj_t* obj);
 void lv_obj_clean(lv_obj_t* obj);
+bool lv_obj_check_type(const lv_obj_t* obj, const lv_obj_class_t* class_p);
+
+/* Redrawing */
+void lv_obj_invalidate(const lv_obj_t* obj);
+void lv_obj_get_coords(const lv_obj_t* obj, lv_area_t* coords);
 
 /* Position and size */
 void lv_obj_set_pos(lv_obj_t* obj, lv_coord_t x, lv_coord_t y);
@@ -568,6 +627,8 @@ void lv_style_set_pad_top(lv_style_t* style, lv_coord_t value);
 void lv_style_set_pad_bottom(lv_style_t* style, lv_coord_t value);
 void lv_style_set_pad_left(lv_style_t* style, lv_coord_t value);
 void lv_style_set_pad_right(lv_style_t* style, lv_coord_t value);
+void lv_style_set_prop(lv_style_t* style, lv_style_prop_t prop, lv_style_value_t value);
+bool lv_style_get_prop(const lv_style_t* style, lv_style_prop_t prop, lv_style_value_t* value);
 
 /* Style selector helper */
 typedef uint32_t lv_style_selector_t;
@@ -575,11 +636,40 @@ typedef uint32_t lv_style_selector_t;
 void lv_obj_add_style(lv_obj_t* obj, lv_style_t* style, lv_style_selector_t selector);
 void lv_obj_remove_style(lv_obj_t* obj, lv_style_t* style, lv_style_selector_t selector);
 void lv_obj_remove_style_all(lv_obj_t* obj);
+void lv_obj_report_style_change(lv_style_t* style);
+void lv_obj_set_local_style_prop(lv_obj_t* obj, lv_style_prop_t prop, lv_style_value_t value, lv_style_selector_t selector);
+
+/* Resolved style lookup: local styles, then added styles, then the theme.
+ * Text properties are inherited from the parent. */
+lv_style_value_t lv_obj_get_style_prop(const lv_obj_t* obj, uint32_t part, lv_style_prop_t prop);
+
+static inline lv_color_t lv_obj_get_style_bg_color(const lv_obj_t* obj, uint32_t part) {
+    return lv_obj_get_style_prop(obj, part, LV_STYLE_BG_COLOR).color;
+}
+static inline lv_opa_t lv_obj_get_style_bg_opa(const lv_obj_t* obj, uint32_t part) {
+    return (lv_opa_t)lv_obj_get_style_prop(obj, part, LV_STYLE_BG_OPA).num;
+}
+static inline lv_color_t lv_obj_get_style_border_color(const lv_obj_t* obj, uint32_t part) {
+    return lv_obj_get_style_prop(obj, part, LV_STYLE_BORDER_COLOR).color;
+}
+static inline lv_coord_t lv_obj_get_style_border_width(const lv_obj_t* obj, uint32_t part) {
+    return (lv_coord_t)lv_obj_get_style_prop(obj, part, LV_STYLE_BORDER_WIDTH).num;
+}
+static inline lv_coord_t lv_obj_get_style_radius(const lv_obj_t* obj, uint32_t part) {
+    return (lv_coord_t)lv_obj_get_style_prop(obj, part, LV_STYLE_RADIUS).num;
+}
+static inline lv_color_t lv_obj_get_style_text_color(const lv_obj_t* obj, uint32_t part) {
+    return lv_obj_get_style_prop(obj, part, LV_STYLE_TEXT_COLOR).color;
+}
+static inline const lv_font_t* lv_obj_get_style_text_font(const lv_obj_t* obj, uint32_t part) {
+    return (const lv_font_t*)lv_obj_get_style_prop(obj, part, LV_STYLE_TEXT_FONT).ptr;
+}
 
 /* Local style setters */
 void lv_obj_set_style_bg_color(lv_obj_t* obj, lv_color_t color, lv_style_selector_t selector);
 void lv_obj_set_style_bg_opa(lv_obj_t* obj, lv_opa_t value, lv_style_selector_t selector);
 void lv_obj_set_style_text_color(lv_obj_t* obj, lv_color_t color, lv_style_selector_t selector);
+void lv_obj_set_style_text_font(lv_obj_t* obj, const lv_font_t* font, lv_style_selector_t selector);
 void lv_obj_set_style_border_width(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector);
 void lv_obj_set_style_border_color(lv_obj_t* obj, lv_color_t color, lv_style_selector_t selector);
 void lv_obj_set_style_radius(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector);
@@ -589,6 +679,13 @@ void lv_obj_set_style_pad_bottom(lv_obj_t* obj, lv_coord_t value, lv_style_selec
 void lv_obj_set_style_pad_left(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector);
 void lv_obj_set_style_pad_right(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector);
 
+/*====================
+ * TEXT
+ *====================*/
+
+void lv_txt_get_size(lv_point_t* size_res, const char* text, const lv_font_t* font,
+                     lv_coord_t letter_space, lv_coord_t line_space, lv_coord_t max_width, uint8_t flag);
+
 /*====================
  * WIDGET: BUTTON
  *====================*/
@@ -661,6 +758,7 @@ void lv_btnmatrix_clear_btn_ctrl(lv_obj_t* obj, uint16_t btn_id, lv_btnmatrix_ct
 void lv_btnmatrix_set_btn_ctrl_all(lv_obj_t* obj, lv_btnmatrix_ctrl_t ctrl);
 void lv_btnmatrix_clear_btn_ctrl_all(lv_obj_t* obj, lv_btnmatrix_ctrl_t ctrl);
 void lv_btnmatrix_set_one_checked(lv_obj_t* obj, bool en);
+const char** lv_btnmatrix_get_map(const lv_obj_t* obj);
 uint16_t lv_btnmatrix_get_selected_btn(const lv_obj_t* obj);
 const char* lv_btnmatrix_get_btn_text(const lv_obj_t* obj, uint16_t btn_id);
 bool lv_btnmatrix_has_btn_ctrl(const lv_obj_t* obj, uint16_t btn_id, lv_btnmatrix_ctrl_t ctrl);
@@ -9,13 +9,22 @@
 #ifndef PROS_RTOS_HPP
 #define PROS_RTOS_HPP
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <string>
 #include <thread>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
+#include "host/task_stats.hpp"
+
+namespace host {
+struct Fiber;
+class FiberScheduler;
+class SimContext;
+}
 
 namespace pros {
 
@@ -57,6 +66,11 @@ using task_fn_t = void (*)(void*);
 #define TASK_PRIORITY_MIN 1
 #define TASK_PRIORITY_DEFAULT 8
 
+/**
+ * Timeout that never expires
+ */
+#define TIMEOUT_MAX ((uint32_t)0xffffffffUL)
+
 /**
  * Task stack size definitions
  */
@@ -65,6 +79,11 @@ using task_fn_t = void (*)(void*);
 
 /**
  * Task class for managing FreeRTOS-style tasks
+ *
+ * Each task runs on its own OS thread, or, when the context's fiber
+ * scheduler is enabled, as a fiber sharing one thread with the other tasks
+ * under FreeRTOS-like scheduling (see host/fiber_scheduler.hpp). Priorities,
+ * suspend() and resume() only take effect with fibers.
  */
 class Task {
 public:
@@ -144,6 +163,19 @@ public:
      */
     bool notify_clear();
 
+    /**
+     * Waits for a notification to the calling task, like FreeRTOS
+     * ulTaskNotifyTake(). Returns at once if the notification value is
+     * already non-zero; otherwise the task sleeps until it is notified or
+     * the timeout passes on the simulation clock.
+     *
+     * @param clear_on_exit True to reset the value to 0, false to decrement it
+     * @param timeout Maximum wait in milliseconds (TIMEOUT_MAX = forever)
+     * @return The value before it was cleared or decremented, or 0 on
+     *         timeout or when not called from a task
+     */
+    static uint32_t notify_take(bool clear_on_exit, uint32_t timeout);
+
     /**
      * Sets the task's priority.
      *
@@ -193,6 +225,24 @@ public:
      */
     static void delay_until(uint32_t* prev_time, uint32_t delta);
 
+    /**
+     * Delay the current task for a given number of microseconds
+     * (host mode only).
+     *
+     * @param microseconds The number of microseconds to wait
+     */
+    static void delay_us(uint64_t microseconds);
+
+    /**
+     * Delay the current task until a given time in microseconds, for loops
+     * with sub-millisecond periods (host mode only). Like delay_until(), it
+     * returns at once if the deadline has passed and counts an overrun.
+     *
+     * @param prev_time_us Pointer to the time the task last woke up
+     * @param delta_us The time to wait
+     */
+    static void delay_until_us(uint64_t* prev_time_us, uint64_t delta_us);
+
     /**
      * Gets the count of currently running tasks.
      *
@@ -200,20 +250,45 @@ public:
      */
     static uint32_t get_count();
 
+    /**
+     * Gets the task's CPU time, wakeup lateness and loop jitter counters
+     * (host mode only).
+     *
+     * @param stats Receives the counters
+     */
+    void get_stats(host::TaskStats& stats);
+
 private:
+    void start(std::function<void()> body);
+
+    uint32_t take_notification(bool clear_on_exit, uint32_t timeout);
+    void wake_waiter(std::unique_lock<std::mutex>& lock);
+    static void wait_for_period(uint64_t target_us, uint64_t period_us);
+    static void record_wakeup(uint64_t target_us, uint64_t period_us, bool overran);
+
     std::thread _thread;
+    host::SimContext* _context;
+    host::FiberScheduler* _scheduler;  // Null when running on a thread
+    host::Fiber* _fiber;
     std::string _name;
     uint32_t _priority;
     task_state_e_t _state;
-    bool _running;
+    std::atomic<bool> _running;
     uint32_t _notification_value;
     bool _notification_pending;
+    bool _notification_waiting;        // A thread task is in notify_take()
+    std::atomic<bool> _notified;       // Set by every notify, for clock waits
     std::mutex _mutex;
     std::condition_variable _cv;
+    host::TaskMonitor _monitor;
 };
 
 /**
- * Mutex class for thread synchronization
+ * Mutex class for task synchronization
+ *
+ * Works across tasks on threads and on fibers. Waiters sleep on the
+ * simulation clock or their fiber scheduler rather than an OS lock, and
+ * give() hands the mutex straight to the highest-priority waiter.
  */
 class Mutex {
 public:
@@ -253,7 +328,12 @@ public:
     void unlock();
 
 private:
-    std::timed_mutex _mutex;
+    struct Waiter;
+
+    std::mutex _mutex;                 // Guards the fields below, never held while waiting
+    std::condition_variable _cv;       // Wakes threads waiting without a timeout
+    bool _locked;
+    std::vector<Waiter*> _waiters;     // In arrival order
 };
 
 /**
@@ -278,10 +358,12 @@ public:
 
 } // namespace pros
 
-// C-style delay function
+// C-style task functions
 extern "C" {
     void task_delay(uint32_t milliseconds);
     void task_delay_until(uint32_t* prev_time, uint32_t delta);
+    void task_delay_until_us(uint64_t* prev_time_us, uint64_t delta_us);
+    uint32_t task_notify_take(bool clear_on_exit, uint32_t timeout);
 }
 
 #endif // PROS_RTOS_HPP
@@ -5,6 +5,9 @@
 
 #include "host/display.hpp"
 #include "host/ipc.hpp"
+#include "host/pixel_ops.hpp"
+#include "host/renderer.hpp"
+#include "host/sim_context.hpp"
 #include "liblvgl/lvgl.h"
 #include <cstring>
 #include <iostream>
@@ -12,8 +15,35 @@
 #include <thread>
 #include <vector>
 #include <map>
+#include <type_traits>
 #include <algorithm>
 #include <cstdarg>
+#include <cstdlib>
+
+// Every lv_* function holds the LVGL lock for its whole body. The flush
+// callbacks are the exception: a driver may finish a flush from another
+// thread while the renderer waits for it with the lock held.
+//
+// LVGL state is process-wide and belongs to the primary context. In a
+// parallel context the object calls are a null sink, so a routine that also
+// draws runs headless instead of racing the screen: they change nothing,
+// creators hand back a placeholder object and getters return zero. Styles
+// are the caller's own memory and work as usual
+class LvglLock {
+public:
+    explicit LvglLock(std::recursive_mutex& mutex)
+        : _lock(mutex), _sink(&host::SimContext::current() != &host::SimContext::primary()) {}
+
+    /** True in a parallel context, where the call must leave LVGL state alone */
+    bool sink() const { return _sink; }
+
+private:
+    std::lock_guard<std::recursive_mutex> _lock;
+    bool _sink;
+};
+
+// What the object creators return in a parallel context. Never drawn or changed
+static lv_obj_t sink_obj = {};
 
 // LVGL global state (simulated)
 static bool lvgl_initialized = false;
@@ -25,8 +55,36 @@ const lv_font_t lv_font_montserrat_12 = {12, 10};
 const lv_font_t lv_font_montserrat_14 = {14, 12};
 const lv_font_t lv_font_montserrat_16 = {16, 14};
 
-// Screen object (root)
-static lv_obj_t screen_obj = {};
+// A style added to an object, or one of its local styles
+struct obj_style_t {
+    lv_style_t* style;
+    lv_style_selector_t selector;
+    bool local;     // Owned by the object (lv_obj_set_style_* calls)
+};
+
+// Event handling - simplified
+struct event_cb_entry {
+    lv_event_cb_t cb;
+    lv_event_code_t filter;
+    void* user_data;
+};
+
+// Object data the simplified lv_obj_t has no room for
+struct _lv_obj_spec_attr_t {
+    std::vector<lv_obj_t*> children;        // In drawing order
+    std::vector<obj_style_t> styles;        // In the order added
+    std::vector<event_cb_entry> events;
+    lv_align_t align = LV_ALIGN_DEFAULT;    // Re-applied when the size changes
+    lv_coord_t align_x = 0;
+    lv_coord_t align_y = 0;
+    bool content_size = false;              // Sized to fit its text (labels)
+};
+
+// Screen object (root). LVGL state below is never destroyed, like real
+// LVGL's static pool: objects may still be deleted during static
+// destruction (the selector's, for one)
+static lv_obj_spec_attr_t& screen_attr = *new lv_obj_spec_attr_t();
+static lv_obj_t screen_obj = {nullptr, {0, 0, 0, 0}, nullptr, nullptr, 0, 0, nullptr, &screen_attr};
 static lv_disp_t display_instance = {};
 
 namespace host {
@@ -42,28 +100,59 @@ Display& Display::instance() {
 }
 
 Display::Display() 
-    : _initialized(false), _disp(nullptr), _indev(nullptr),
+    : _initialized(false), _mode(DisplayMode::PARTIAL), _disp(nullptr), _indev(nullptr),
+      _front(_framebuffer),
+      _dirty_count(0), _frame_period_ms(LV_DISP_DEF_REFR_PERIOD),
+      _keyframe_interval_ms(DEFAULT_KEYFRAME_INTERVAL), _keyframe_requested(true),
       _touch_x(0), _touch_y(0), _touch_pressed(false) {
     memset(_framebuffer, 0, sizeof(_framebuffer));
+    memset(_shadow, 0, sizeof(_shadow));
+    _updates.resize(MAX_DIRTY_RECTS);
 }
 
 Display::~Display() {
     shutdown();
 }
 
-void Display::init() {
+static const char* mode_name(DisplayMode mode) {
+    switch (mode) {
+        case DisplayMode::PARTIAL:      return "partial";
+        case DisplayMode::DIRECT:       return "direct";
+        case DisplayMode::FULL_REFRESH: return "full refresh";
+    }
+    return "unknown";
+}
+
+void Display::init(DisplayMode mode) {
     if (_initialized) return;
     
     // Initialize LVGL
     lv_init();
     
     // Initialize draw buffer
-    lv_disp_draw_buf_init(&_draw_buf, _buf1, _buf2, WIDTH * (HEIGHT / 10));
+    _mode = mode;
+    _front = _framebuffer;
+    switch (mode) {
+        case DisplayMode::PARTIAL:
+            _back_page.clear();
+            lv_disp_draw_buf_init(&_draw_buf, _buf1, _buf2, WIDTH * (HEIGHT / 10));
+            break;
+        case DisplayMode::DIRECT:
+            _back_page.clear();
+            lv_disp_draw_buf_init(&_draw_buf, _framebuffer, nullptr, BUFFER_SIZE);
+            break;
+        case DisplayMode::FULL_REFRESH:
+            _back_page.assign(BUFFER_SIZE, 0);
+            lv_disp_draw_buf_init(&_draw_buf, _framebuffer, _back_page.data(), BUFFER_SIZE);
+            break;
+    }
     
     // Initialize display driver
     lv_disp_drv_init(&_disp_drv);
     _disp_drv.hor_res = WIDTH;
     _disp_drv.ver_res = HEIGHT;
+    _disp_drv.direct_mode = mode == DisplayMode::DIRECT;
+    _disp_drv.full_refresh = mode == DisplayMode::FULL_REFRESH;
     _disp_drv.flush_cb = disp_flush_cb;
     _disp_drv.draw_buf = &_draw_buf;
     _disp_drv.user_data = this;
@@ -78,7 +167,8 @@ void Display::init() {
     
     _initialized = true;
     
-    std::cout << "LVGL display initialized (" << WIDTH << "x" << HEIGHT << ")" << std::endl;
+    std::cout << "LVGL display initialized (" << WIDTH << "x" << HEIGHT << ", "
+              << mode_name(mode) << " mode)" << std::endl;
 }
 
 void Display::shutdown() {
@@ -94,6 +184,10 @@ bool Display::is_initialized() {
     return _initialized;
 }
 
+DisplayMode Display::get_mode() {
+    return _mode;
+}
+
 void Display::set_touch(int16_t x, int16_t y, bool pressed) {
     _touch_x = x;
     _touch_y = y;
@@ -103,51 +197,259 @@ void Display::set_touch(int16_t x, int16_t y, bool pressed) {
 void Display::update() {
     if (!_initialized) return;
     
-    // Update LVGL tick
+    // Update LVGL tick and handle LVGL tasks. Tasks may be changing objects
+    // on other threads, so the object tree is only read under the lock
     auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lvgl_start_time);
-    lv_tick_inc(static_cast<uint32_t>(elapsed.count()) - lvgl_tick_count);
-    lvgl_tick_count = static_cast<uint32_t>(elapsed.count());
+    {
+        LvglLock lock(lvgl_mutex());
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lvgl_start_time);
+        lv_tick_inc(static_cast<uint32_t>(elapsed.count()) - lvgl_tick_count);
+        lvgl_tick_count = static_cast<uint32_t>(elapsed.count());
+        lv_timer_handler();
+    }
     
-    // Handle LVGL tasks
-    lv_timer_handler();
+    // A dropped screen frame leaves the UI behind our shadow copy
+    IPCClient& ipc = IPCClient::instance();
+    if (ipc.consume_screen_drop()) {
+        _keyframe_requested = true;
+    }
+    
+    // Emit accumulated dirty areas once per frame period. While the last
+    // frame is still waiting for the writer they keep accumulating instead
+    bool keyframe = _keyframe_requested.load();
+    if ((_dirty_count > 0 || keyframe) &&
+        now - _last_frame >= std::chrono::milliseconds(_frame_period_ms) &&
+        !(ipc.is_connected() && ipc.screen_pending())) {
+        // Periodically resend everything so a viewer can never drift for long
+        if (_keyframe_interval_ms > 0 &&
+            now - _last_keyframe >= std::chrono::milliseconds(_keyframe_interval_ms)) {
+            keyframe = true;
+        }
+        
+        emit_frame(keyframe);
+        _last_frame = now;
+        if (keyframe) _last_keyframe = now;
+    }
+}
+
+void Display::request_keyframe() {
+    _keyframe_requested = true;
+}
+
+void Display::set_keyframe_interval(uint32_t interval_ms) {
+    _keyframe_interval_ms = interval_ms;
+}
+
+bool Display::enable_shared_memory(const std::string& name) {
+    return _shared.open(name, WIDTH, HEIGHT);
+}
+
+void Display::set_max_fps(uint32_t fps) {
+    uint32_t period = fps > 0 ? (1000 + fps - 1) / fps : LV_DISP_DEF_REFR_PERIOD;
+    _frame_period_ms = std::max<uint32_t>(period, LV_DISP_DEF_REFR_PERIOD);
+}
+
+uint32_t Display::get_frame_period() {
+    return _frame_period_ms;
 }
 
 const uint16_t* Display::get_framebuffer() {
-    return _framebuffer;
+    return _front;
 }
 
-void Display::disp_flush_cb(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p) {
-    Display* self = static_cast<Display*>(drv->user_data);
+// Area helpers for the frame compositor
+static int32_t area_size(const lv_area_t& a) {
+    return (a.x2 - a.x1 + 1) * (a.y2 - a.y1 + 1);
+}
+
+static lv_area_t area_union(const lv_area_t& a, const lv_area_t& b) {
+    return {std::min(a.x1, b.x1), std::min(a.y1, b.y1),
+            std::max(a.x2, b.x2), std::max(a.y2, b.y2)};
+}
+
+static bool area_touches(const lv_area_t& a, const lv_area_t& b) {
+    return a.x1 <= b.x2 + 1 && b.x1 <= a.x2 + 1 &&
+           a.y1 <= b.y2 + 1 && b.y1 <= a.y2 + 1;
+}
+
+void Display::mark_dirty(const lv_area_t& area) {
+    // Clip to the screen
+    lv_area_t a = {std::max<lv_coord_t>(area.x1, 0), std::max<lv_coord_t>(area.y1, 0),
+                   std::min<lv_coord_t>(area.x2, WIDTH - 1), std::min<lv_coord_t>(area.y2, HEIGHT - 1)};
+    if (a.x1 > a.x2 || a.y1 > a.y2) return;
     
-    // Copy to framebuffer
-    for (int32_t y = area->y1; y <= area->y2; y++) {
-        for (int32_t x = area->x1; x <= area->x2; x++) {
-            if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT) {
-                self->_framebuffer[y * WIDTH + x] = color_p->full;
+    // Merge with touching rectangles as long as the union wastes no pixels
+    // (e.g. consecutive draw-buffer strips). Repeat since a merged area may
+    // now touch others.
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < _dirty_count; i++) {
+            if (!area_touches(a, _dirty[i])) continue;
+            lv_area_t u = area_union(a, _dirty[i]);
+            if (area_size(u) <= area_size(a) + area_size(_dirty[i])) {
+                a = u;
+                _dirty[i] = _dirty[--_dirty_count];
+                merged = true;
+                break;
             }
-            color_p++;
         }
     }
     
-    // Send to IPC if connected
-    if (IPCClient::instance().is_connected()) {
-        ScreenUpdate update;
-        update.x1 = area->x1;
-        update.y1 = area->y1;
-        update.x2 = area->x2;
-        update.y2 = area->y2;
+    if (_dirty_count < MAX_DIRTY_RECTS) {
+        _dirty[_dirty_count++] = a;
+        return;
+    }
+    
+    // Too many separate areas: collapse into the bounding box
+    for (int i = 0; i < _dirty_count; i++) {
+        a = area_union(a, _dirty[i]);
+    }
+    _dirty[0] = a;
+    _dirty_count = 1;
+}
+
+// Encodes the pixels of an area that differ from the previous frame as
+// DELTA_SPANS words. Unchanged gaps of a single pixel are folded into the
+// surrounding run since a new span header would cost more than the pixel.
+// Gives up (returning false) once the encoding reaches `limit` words, at
+// which point sending the raw area is no larger.
+static bool encode_delta(const uint16_t* cur, const uint16_t* prev, const lv_area_t& a,
+                         size_t limit, std::vector<uint16_t>& out) {
+    uint32_t skip = 0;
+    
+    for (int32_t y = a.y1; y <= a.y2; y++) {
+        const uint16_t* c = cur + y * Display::WIDTH;
+        const uint16_t* p = prev + y * Display::WIDTH;
+        int32_t x = a.x1;
         
-        // Copy affected region
-        for (int32_t y = area->y1; y <= area->y2; y++) {
-            for (int32_t x = area->x1; x <= area->x2; x++) {
-                if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT) {
-                    update.pixels.push_back(self->_framebuffer[y * WIDTH + x]);
-                }
+        while (x <= a.x2) {
+            while (x <= a.x2 && c[x] == p[x]) {
+                skip++;
+                x++;
+            }
+            if (x > a.x2) break;
+            
+            int32_t start = x;
+            while (x <= a.x2 && (c[x] != p[x] || (x + 1 <= a.x2 && c[x + 1] != p[x + 1]))) {
+                x++;
             }
+            
+            while (skip > 0xFFFF) {
+                out.push_back(0xFFFF);
+                out.push_back(0);
+                skip -= 0xFFFF;
+            }
+            out.push_back(static_cast<uint16_t>(skip));
+            out.push_back(static_cast<uint16_t>(x - start));
+            out.insert(out.end(), c + start, c + x);
+            skip = 0;
+            if (out.size() >= limit) return false;
         }
+    }
+    return true;
+}
+
+void Display::emit_frame(bool keyframe) {
+    if (_shared.is_open()) {
+        // Local viewers read shared memory directly, connected or not
+        _keyframe_requested = false;
+        uint64_t frame = _shared.publish(_front, _dirty, _dirty_count, keyframe);
+        _dirty_count = 0;
+        IPCClient::instance().send_screen_notify(_shared.name(), frame, keyframe);
+        return;
+    }
+    
+    if (!IPCClient::instance().is_connected()) {
+        // Nobody is watching; whoever connects next needs the full screen
+        _keyframe_requested = true;
+        _dirty_count = 0;
+        return;
+    }
+    
+    // Raw records point into the framebuffer and are copied from there
+    // straight into the outgoing frame
+    size_t count = 0;
+    
+    if (keyframe) {
+        _keyframe_requested = false;
         
-        IPCClient::instance().send_screen_update(update);
+        ScreenUpdate& update = _updates[count++];
+        update.x1 = 0;
+        update.y1 = 0;
+        update.x2 = WIDTH - 1;
+        update.y2 = HEIGHT - 1;
+        update.encoding = ScreenEncoding::RAW_RGB565;
+        update.flags = SCREEN_FLAG_KEYFRAME;
+        update.source = _front;
+        update.source_stride = WIDTH;
+        
+        memcpy(_shadow, _front, sizeof(_shadow));
+    } else {
+        for (int i = 0; i < _dirty_count; i++) {
+            const lv_area_t& a = _dirty[i];
+            ScreenUpdate& update = _updates[count];
+            update.x1 = a.x1;
+            update.y1 = a.y1;
+            update.x2 = a.x2;
+            update.y2 = a.y2;
+            update.flags = 0;
+            update.pixels.clear();
+            
+            // Fall back to raw pixels when most of the area changed
+            if (encode_delta(_front, _shadow, a, area_size(a), update.pixels)) {
+                if (update.pixels.empty()) continue; // Redrawn but unchanged
+                update.encoding = ScreenEncoding::DELTA_SPANS;
+                update.source = nullptr;
+            } else {
+                update.encoding = ScreenEncoding::RAW_RGB565;
+                update.source = &_front[a.y1 * WIDTH + a.x1];
+                update.source_stride = WIDTH;
+            }
+            
+            pixel_copy(&_shadow[a.y1 * WIDTH + a.x1], WIDTH, &_front[a.y1 * WIDTH + a.x1], WIDTH,
+                       a.x2 - a.x1 + 1, a.y2 - a.y1 + 1);
+            count++;
+        }
+    }
+    
+    _dirty_count = 0;
+    IPCClient::instance().send_screen_batch(_updates.data(), count);
+}
+
+void Display::disp_flush_cb(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p) {
+    Display* self = static_cast<Display*>(drv->user_data);
+    
+    switch (self->_mode) {
+        case DisplayMode::PARTIAL: {
+            // Copy the part of the area that is on screen to the framebuffer
+            int32_t stride = area->x2 - area->x1 + 1;
+            lv_area_t clip = {
+                static_cast<lv_coord_t>(std::max<int32_t>(area->x1, 0)),
+                static_cast<lv_coord_t>(std::max<int32_t>(area->y1, 0)),
+                static_cast<lv_coord_t>(std::min<int32_t>(area->x2, WIDTH - 1)),
+                static_cast<lv_coord_t>(std::min<int32_t>(area->y2, HEIGHT - 1))
+            };
+            if (clip.x1 <= clip.x2 && clip.y1 <= clip.y2) {
+                const lv_color_t* src = color_p + (clip.y1 - area->y1) * stride + (clip.x1 - area->x1);
+                pixel_copy(&self->_framebuffer[clip.y1 * WIDTH + clip.x1], WIDTH, &src->full, stride,
+                           clip.x2 - clip.x1 + 1, clip.y2 - clip.y1 + 1);
+                
+                // Defer sending; the compositor emits one batched update per frame
+                self->mark_dirty(clip);
+            }
+            break;
+        }
+        case DisplayMode::DIRECT:
+            // Already drawn into the framebuffer
+            self->mark_dirty(*area);
+            break;
+        case DisplayMode::FULL_REFRESH:
+            // Page flip: the flushed page is now the screen. Every refresh
+            // redraws it all, so delta encoding finds what actually changed.
+            self->_front = &color_p->full;
+            self->mark_dirty(*area);
+            break;
     }
     
     // Inform LVGL that flushing is complete
@@ -175,6 +477,12 @@ void lvgl_update() {
     Display::instance().update();
 }
 
+std::recursive_mutex& lvgl_mutex() {
+    // Never destroyed: objects may still be deleted during static destruction
+    static std::recursive_mutex* mutex = new std::recursive_mutex();
+    return *mutex;
+}
+
 } // namespace host
 
 /*====================
@@ -184,6 +492,8 @@ void lvgl_update() {
  *====================*/
 
 void lv_init(void) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     if (lvgl_initialized) return;
     lvgl_initialized = true;
     lvgl_start_time = std::chrono::steady_clock::now();
@@ -193,30 +503,41 @@ void lv_init(void) {
     memset(&screen_obj, 0, sizeof(screen_obj));
     screen_obj.coords.x1 = 0;
     screen_obj.coords.y1 = 0;
-    screen_obj.coords.x2 = 479;
-    screen_obj.coords.y2 = 271;
+    screen_obj.coords.x2 = LV_HOR_RES_MAX;
+    screen_obj.coords.y2 = LV_VER_RES_MAX;
+    screen_obj.class_p = &lv_obj_class;
+    screen_obj.spec_attr = &screen_attr;
     
     // Initialize display instance
     display_instance.act_scr = &screen_obj;
 }
 
 void lv_deinit(void) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     lvgl_initialized = false;
 }
 
 void lv_tick_inc(uint32_t tick_period) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     lvgl_tick_count += tick_period;
 }
 
 uint32_t lv_tick_get(void) {
+    LvglLock lock(host::lvgl_mutex());
     auto now = std::chrono::steady_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lvgl_start_time);
     return static_cast<uint32_t>(elapsed.count());
 }
 
 void lv_timer_handler(void) {
-    // In a full implementation, this would process animations and redraws
-    // For the stub, we just ensure callbacks are processed
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    // Redraw whatever changed since the last call
+    if (lvgl_initialized) {
+        host::render_invalidated(&display_instance);
+    }
 }
 
 /*====================
@@ -224,6 +545,7 @@ void lv_timer_handler(void) {
  *====================*/
 
 void lv_disp_draw_buf_init(lv_disp_draw_buf_t* draw_buf, void* buf1, void* buf2, uint32_t size_in_px_cnt) {
+    LvglLock lock(host::lvgl_mutex());
     draw_buf->buf1 = buf1;
     draw_buf->buf2 = buf2;
     draw_buf->buf_act = buf1;
@@ -231,6 +553,7 @@ void lv_disp_draw_buf_init(lv_disp_draw_buf_t* draw_buf, void* buf1, void* buf2,
 }
 
 void lv_disp_drv_init(lv_disp_drv_t* driver) {
+    LvglLock lock(host::lvgl_mutex());
     memset(driver, 0, sizeof(lv_disp_drv_t));
     driver->hor_res = LV_HOR_RES_MAX;
     driver->ver_res = LV_VER_RES_MAX;
@@ -239,22 +562,66 @@ void lv_disp_drv_init(lv_disp_drv_t* driver) {
 }
 
 lv_disp_t* lv_disp_drv_register(lv_disp_drv_t* driver) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return nullptr;
     display_instance.driver = driver;
     display_instance.act_scr = &screen_obj;
+    
+    // Draw the whole screen once
+    display_instance.inv_p = 0;
+    lv_obj_invalidate(&screen_obj);
     return &display_instance;
 }
 
+lv_disp_t* lv_disp_get_default(void) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return nullptr;
+    return display_instance.driver ? &display_instance : nullptr;
+}
+
+void _lv_inv_area(lv_disp_t* disp, const lv_area_t* area_p) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!disp || !disp->driver) return;
+    
+    // Clip to the screen
+    lv_area_t a = {std::max<lv_coord_t>(area_p->x1, 0), std::max<lv_coord_t>(area_p->y1, 0),
+                   std::min<lv_coord_t>(area_p->x2, disp->driver->hor_res - 1),
+                   std::min<lv_coord_t>(area_p->y2, disp->driver->ver_res - 1)};
+    if (a.x1 > a.x2 || a.y1 > a.y2) return;
+    
+    // Already covered?
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        const lv_area_t& b = disp->inv_areas[i];
+        if (a.x1 >= b.x1 && a.y1 >= b.y1 && a.x2 <= b.x2 && a.y2 <= b.y2) return;
+    }
+    
+    // Out of slots: redraw the whole screen
+    if (disp->inv_p == LV_INV_BUF_SIZE) {
+        disp->inv_areas[0] = {0, 0, static_cast<lv_coord_t>(disp->driver->hor_res - 1),
+                              static_cast<lv_coord_t>(disp->driver->ver_res - 1)};
+        disp->inv_p = 1;
+        return;
+    }
+    disp->inv_areas[disp->inv_p++] = a;
+}
+
 void lv_disp_flush_ready(lv_disp_drv_t* disp_drv) {
     if (disp_drv && disp_drv->draw_buf) {
         disp_drv->draw_buf->flushing = 0;
     }
 }
 
+bool lv_disp_flush_is_last(lv_disp_drv_t* disp_drv) {
+    return disp_drv && disp_drv->draw_buf && disp_drv->draw_buf->flushing_last;
+}
+
 /*====================
  * INPUT DRIVER STUBS
  *====================*/
 
 void lv_indev_drv_init(lv_indev_drv_t* driver) {
+    LvglLock lock(host::lvgl_mutex());
     memset(driver, 0, sizeof(lv_indev_drv_t));
     driver->type = LV_INDEV_TYPE_POINTER;
 }
@@ -262,6 +629,8 @@ void lv_indev_drv_init(lv_indev_drv_t* driver) {
 static lv_indev_t indev_instance = {};
 
 lv_indev_t* lv_indev_drv_register(lv_indev_drv_t* driver) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return nullptr;
     indev_instance.driver = driver;
     return &indev_instance;
 }
@@ -271,14 +640,22 @@ lv_indev_t* lv_indev_drv_register(lv_indev_drv_t* driver) {
  *====================*/
 
 lv_obj_t* lv_scr_act(void) {
-    return &screen_obj;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return &sink_obj;
+    return display_instance.act_scr ? display_instance.act_scr : &screen_obj;
 }
 
 void lv_scr_load(lv_obj_t* scr) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!scr || scr == display_instance.act_scr) return;
     display_instance.act_scr = scr;
+    lv_obj_invalidate(scr);
 }
 
 void lv_scr_load_anim(lv_obj_t* scr, int anim_type, uint32_t time, uint32_t delay, bool auto_del) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     (void)anim_type;
     (void)time;
     (void)delay;
@@ -314,89 +691,471 @@ void* lv_event_get_param(lv_event_t* e) {
  * OBJECT FUNCTIONS
  *====================*/
 
-// Simple object allocator
-static std::vector<lv_obj_t*> allocated_objects;
+// Widget classes
+const lv_obj_class_t lv_obj_class = {nullptr, "lv_obj"};
+const lv_obj_class_t lv_btn_class = {&lv_obj_class, "lv_btn"};
+const lv_obj_class_t lv_label_class = {&lv_obj_class, "lv_label"};
+const lv_obj_class_t lv_bar_class = {&lv_obj_class, "lv_bar"};
+const lv_obj_class_t lv_btnmatrix_class = {&lv_obj_class, "lv_btnmatrix"};
+const lv_obj_class_t lv_tabview_class = {&lv_obj_class, "lv_tabview"};
+
+static lv_obj_spec_attr_t* find_ext(const lv_obj_t* obj) {
+    return obj ? obj->spec_attr : nullptr;
+}
+
+// Objects are allocated from slabs that are never freed. A deleted object's
+// slot goes on an intrusive free list for the next lv_obj_create(), so
+// creating an object costs the same however many exist. Slots keep their
+// attribute vectors' capacity between objects.
+//
+// lv_obj_del() checks that a pointer is the start of a slot in one of the
+// slabs before reading it, so foreign pointers are ignored. A stale pointer
+// to a slot that was reused still names the new object, as in LVGL; debug
+// builds reuse the least recently freed slot and report deletes of dead
+// slots, which catches most of these.
+struct obj_slot_t {
+    lv_obj_t obj;                   // First, so an object's address is its slot's
+    obj_slot_t* next_free;          // Free list link while the slot is unused
+    lv_obj_spec_attr_t* attr;       // This slot's entry in its slab's attrs
+    bool live;
+};
+
+static_assert(std::is_standard_layout<obj_slot_t>::value, "slot_of() relies on obj being first");
+
+static constexpr size_t OBJ_SLAB_SIZE = 64;
+
+struct obj_slab_t {
+    obj_slot_t slots[OBJ_SLAB_SIZE];
+    lv_obj_spec_attr_t attrs[OBJ_SLAB_SIZE];
+};
+
+// Bytes an object takes from the pool, counted against LV_MEM_SIZE
+static constexpr uint32_t OBJ_MEM_SIZE = sizeof(obj_slot_t) + sizeof(lv_obj_spec_attr_t);
+
+static std::vector<obj_slab_t*>& obj_slabs = *new std::vector<obj_slab_t*>();  // By address
+static obj_slot_t* free_slots = nullptr;        // Next slot to hand out
+#ifndef NDEBUG
+static obj_slot_t* free_slots_tail = nullptr;
+#endif
+static uint32_t live_objects = 0;
+static uint32_t max_live_objects = 0;
+static uint32_t max_used_bytes = 0;             // Peak seen by lv_mem_monitor()
+
+// Finds the slot an object pointer points at, or null if it does not point
+// at the start of a pooled object
+static obj_slot_t* slot_of(const lv_obj_t* obj) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(obj);
+    auto it = std::upper_bound(obj_slabs.begin(), obj_slabs.end(), address,
+                               [](uintptr_t a, const obj_slab_t* slab) {
+                                   return a < reinterpret_cast<uintptr_t>(slab);
+                               });
+    if (it == obj_slabs.begin()) return nullptr;
+    obj_slab_t* slab = *--it;
+
+    uintptr_t offset = address - reinterpret_cast<uintptr_t>(slab->slots);
+    if (offset >= sizeof(slab->slots) || offset % sizeof(obj_slot_t) != 0) return nullptr;
+    return &slab->slots[offset / sizeof(obj_slot_t)];
+}
+
+static obj_slot_t* alloc_slot() {
+    if (!free_slots) {
+        obj_slab_t* slab = new obj_slab_t();
+        obj_slabs.insert(std::upper_bound(obj_slabs.begin(), obj_slabs.end(), slab), slab);
+        for (size_t i = OBJ_SLAB_SIZE; i-- > 0;) {
+            slab->slots[i].attr = &slab->attrs[i];
+            slab->slots[i].live = false;
+            slab->slots[i].next_free = free_slots;
+            free_slots = &slab->slots[i];
+        }
+#ifndef NDEBUG
+        free_slots_tail = &slab->slots[OBJ_SLAB_SIZE - 1];
+#endif
+    }
+    obj_slot_t* slot = free_slots;
+    free_slots = slot->next_free;
+#ifndef NDEBUG
+    if (!free_slots) free_slots_tail = nullptr;
+#endif
+    slot->live = true;
+
+    live_objects++;
+    if (live_objects > max_live_objects) {
+        max_live_objects = live_objects;
+        if (max_live_objects * OBJ_MEM_SIZE > LV_MEM_SIZE &&
+            (max_live_objects - 1) * OBJ_MEM_SIZE <= LV_MEM_SIZE) {
+            std::cout << "Warning: " << max_live_objects << " LVGL objects exceed LV_MEM_SIZE ("
+                      << LV_MEM_SIZE << " bytes)" << std::endl;
+        }
+    }
+    return slot;
+}
+
+static void free_slot(obj_slot_t* slot) {
+    // Empty the attributes but keep their vectors' capacity for the next object
+    lv_obj_spec_attr_t& attr = *slot->attr;
+    attr.children.clear();
+    attr.styles.clear();
+    attr.events.clear();
+    attr.align = LV_ALIGN_DEFAULT;
+    attr.align_x = 0;
+    attr.align_y = 0;
+    attr.content_size = false;
+
+    slot->live = false;
+#ifdef NDEBUG
+    // Hand the slot out next, while it is still in cache
+    slot->next_free = free_slots;
+    free_slots = slot;
+#else
+    // Hand it out last, so a stale pointer to it stays dead for as long as
+    // possible and lv_obj_del() can report it
+    slot->next_free = nullptr;
+    if (free_slots_tail) {
+        free_slots_tail->next_free = slot;
+    } else {
+        free_slots = slot;
+    }
+    free_slots_tail = slot;
+#endif
+    live_objects--;
+}
+
+// Widget data, removed along with the object
+static std::map<lv_obj_t*, std::string>& label_texts = *new std::map<lv_obj_t*, std::string>();
+
+struct tabview_data {
+    lv_obj_t* btns = nullptr;
+    lv_obj_t* content = nullptr;
+    lv_dir_t tab_pos = LV_DIR_TOP;
+    lv_coord_t tab_size = 0;
+    std::vector<lv_obj_t*> tabs;
+    std::vector<std::string> names;
+    std::vector<const char*> map;           // Button map pointing into names
+    uint16_t active = 0;
+};
+static std::map<lv_obj_t*, tabview_data>& tabview_map = *new std::map<lv_obj_t*, tabview_data>();
+static void tabview_forget(lv_obj_t* obj);
+
+struct btnmatrix_data {
+    const char** map = nullptr;
+    std::vector<std::string> texts;         // Button texts without the "\n" row breaks
+    std::vector<uint16_t> ctrls;
+    uint16_t selected = 0;
+    bool one_checked = false;
+};
+static std::map<const lv_obj_t*, btnmatrix_data>& btnm_map = *new std::map<const lv_obj_t*, btnmatrix_data>();
+
+struct bar_data {
+    int32_t min = 0;
+    int32_t max = 100;
+    int32_t value = 0;
+};
+static std::map<const lv_obj_t*, bar_data>& bar_map = *new std::map<const lv_obj_t*, bar_data>();
+
+// Heap bytes behind a style's properties (defined with the style functions)
+static size_t style_bytes(const lv_style_t* style);
+
+// Map node cost on top of the key and value
+static constexpr size_t MAP_NODE_OVERHEAD = 4 * sizeof(void*);
+
+template <typename T>
+static size_t vector_bytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+static size_t string_bytes(const std::string& str) {
+    return str.capacity() + 1;
+}
+
+// Bytes used by objects and everything they own, counted against
+// LV_MEM_SIZE: slots, attribute vectors, local styles and widget data.
+// Shared styles belong to the caller and are not counted.
+static size_t used_bytes() {
+    size_t used = live_objects * OBJ_MEM_SIZE;
+    for (const obj_slab_t* slab : obj_slabs) {
+        for (const obj_slot_t& slot : slab->slots) {
+            if (!slot.live) continue;
+            const lv_obj_spec_attr_t& attr = *slot.attr;
+            used += vector_bytes(attr.children) + vector_bytes(attr.styles) + vector_bytes(attr.events);
+            for (const obj_style_t& style : attr.styles) {
+                if (style.local) used += sizeof(lv_style_t) + style_bytes(style.style);
+            }
+        }
+    }
+    for (const auto& entry : label_texts) {
+        used += MAP_NODE_OVERHEAD + sizeof(entry) + string_bytes(entry.second);
+    }
+    for (const auto& entry : btnm_map) {
+        const btnmatrix_data& data = entry.second;
+        used += MAP_NODE_OVERHEAD + sizeof(entry) + vector_bytes(data.texts) + vector_bytes(data.ctrls);
+        for (const std::string& text : data.texts) used += string_bytes(text);
+    }
+    for (const auto& entry : tabview_map) {
+        const tabview_data& data = entry.second;
+        used += MAP_NODE_OVERHEAD + sizeof(entry) + vector_bytes(data.tabs) + vector_bytes(data.names) +
+                vector_bytes(data.map);
+        for (const std::string& name : data.names) used += string_bytes(name);
+    }
+    used += bar_map.size() * (MAP_NODE_OVERHEAD + sizeof(*bar_map.begin()));
+    return used;
+}
+
+void lv_mem_monitor(lv_mem_monitor_t* mon_p) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) {
+        if (mon_p) *mon_p = {};
+        return;
+    }
+    if (!mon_p) return;
+    uint32_t used = static_cast<uint32_t>(used_bytes());
+    max_used_bytes = std::max({max_used_bytes, used, max_live_objects * OBJ_MEM_SIZE});
+    uint32_t free_size = used < LV_MEM_SIZE ? LV_MEM_SIZE - used : 0;
+    mon_p->total_size = LV_MEM_SIZE;
+    mon_p->free_cnt = static_cast<uint32_t>(obj_slabs.size() * OBJ_SLAB_SIZE) - live_objects;
+    mon_p->free_size = free_size;
+    mon_p->free_biggest_size = free_size;   // Slots are all alike, nothing fragments
+    mon_p->used_cnt = live_objects;
+    mon_p->max_used = max_used_bytes;
+    mon_p->used_pct = static_cast<uint8_t>(std::min<uint32_t>(100, used * 100 / LV_MEM_SIZE));
+    mon_p->frag_pct = 0;
+}
+
+static lv_style_value_t num_value(int32_t num) {
+    lv_style_value_t value = {};
+    value.num = num;
+    return value;
+}
+
+static lv_style_value_t color_value(lv_color_t color) {
+    lv_style_value_t value = {};
+    value.color = color;
+    return value;
+}
+
+static lv_style_value_t ptr_value(const void* ptr) {
+    lv_style_value_t value = {};
+    value.ptr = ptr;
+    return value;
+}
 
 lv_obj_t* lv_obj_create(lv_obj_t* parent) {
-    lv_obj_t* obj = new lv_obj_t();
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return &sink_obj;
+    obj_slot_t* slot = alloc_slot();
+    lv_obj_t* obj = &slot->obj;
     memset(obj, 0, sizeof(lv_obj_t));
     obj->parent = parent;
     obj->flags = LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE;
-    allocated_objects.push_back(obj);
+    obj->class_p = &lv_obj_class;
+    obj->spec_attr = slot->attr;
+
+    if (parent) {
+        parent->spec_attr->children.push_back(obj);
+    } else {
+        // A new screen covers the display
+        obj->coords.x2 = LV_HOR_RES_MAX;
+        obj->coords.y2 = LV_VER_RES_MAX;
+    }
     return obj;
 }
 
 void lv_obj_del(lv_obj_t* obj) {
-    if (!obj) return;
-    auto it = std::find(allocated_objects.begin(), allocated_objects.end(), obj);
-    if (it != allocated_objects.end()) {
-        allocated_objects.erase(it);
-        delete obj;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    // The default screen is not pooled and cannot be deleted. Anything that
+    // is not a live pooled object is ignored
+    if (!obj || obj == &screen_obj) return;
+    obj_slot_t* slot = slot_of(obj);
+    if (!slot || !slot->live) {
+#ifndef NDEBUG
+        std::cerr << "lv_obj_del: " << obj << " is not a live object (deleted already, or not from lv_obj_create)"
+                  << std::endl;
+#endif
+        return;
+    }
+    lv_obj_invalidate(obj);
+
+    // Children go with their parent, last first so none of them shift
+    lv_obj_spec_attr_t* attr = obj->spec_attr;
+    while (!attr->children.empty()) {
+        lv_obj_del(attr->children.back());
+    }
+    for (obj_style_t& s : attr->styles) {
+        if (!s.local) continue;
+        lv_style_reset(s.style);
+        delete s.style;
+    }
+    if (lv_obj_spec_attr_t* parent = find_ext(obj->parent)) {
+        auto it = std::find(parent->children.rbegin(), parent->children.rend(), obj);
+        if (it != parent->children.rend()) parent->children.erase(std::next(it).base());
+    }
+    tabview_forget(obj);
+
+    // Deleting the loaded screen shows the default one again
+    if (display_instance.act_scr == obj) {
+        display_instance.act_scr = &screen_obj;
+        lv_obj_invalidate(&screen_obj);
     }
+
+    label_texts.erase(obj);
+    tabview_map.erase(obj);
+    btnm_map.erase(obj);
+    bar_map.erase(obj);
+    free_slot(slot);
 }
 
 void lv_obj_clean(lv_obj_t* obj) {
-    (void)obj;
-    // In full implementation, would delete all children
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    lv_obj_spec_attr_t* ext = find_ext(obj);
+    if (!ext) return;
+    while (!ext->children.empty()) {
+        lv_obj_del(ext->children.back());
+    }
+}
+
+bool lv_obj_check_type(const lv_obj_t* obj, const lv_obj_class_t* class_p) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return false;
+    return obj && (obj->class_p ? obj->class_p : &lv_obj_class) == class_p;
+}
+
+void lv_obj_get_coords(const lv_obj_t* obj, lv_area_t* coords) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) {
+        *coords = {};
+        return;
+    }
+    // Stored coordinates are relative to the parent
+    lv_coord_t x = 0, y = 0;
+    for (const lv_obj_t* p = obj->parent; p; p = p->parent) {
+        x += p->coords.x1;
+        y += p->coords.y1;
+    }
+    coords->x1 = x + obj->coords.x1;
+    coords->y1 = y + obj->coords.y1;
+    coords->x2 = x + obj->coords.x2 - 1;
+    coords->y2 = y + obj->coords.y2 - 1;
+}
+
+void lv_obj_invalidate(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!obj || !display_instance.driver) return;
+
+    // Hidden objects and objects off the active screen cover nothing
+    const lv_obj_t* root = obj;
+    for (; root->parent; root = root->parent) {
+        if (root->flags & LV_OBJ_FLAG_HIDDEN) return;
+    }
+    if (root != display_instance.act_scr) return;
+
+    lv_area_t area;
+    lv_obj_get_coords(obj, &area);
+    _lv_inv_area(&display_instance, &area);
+}
+
+static void tabview_layout(lv_obj_t* tv);
+static void apply_align(lv_obj_t* obj);
+
+// Moves or resizes an object within its parent, redrawing the old and new area
+static void set_coords(lv_obj_t* obj, lv_coord_t x, lv_coord_t y, lv_coord_t w, lv_coord_t h) {
+    lv_area_t coords = {x, y, static_cast<lv_coord_t>(x + w), static_cast<lv_coord_t>(y + h)};
+    if (memcmp(&coords, &obj->coords, sizeof(coords)) == 0) return;
+    bool resized = w != lv_obj_get_width(obj) || h != lv_obj_get_height(obj);
+
+    lv_obj_invalidate(obj);
+    obj->coords = coords;
+    lv_obj_invalidate(obj);
+    if (!resized) return;
+
+    // Keep aligned objects (this one and its children) in place
+    lv_obj_spec_attr_t* ext = find_ext(obj);
+    if (!ext) return;
+    if (ext->align != LV_ALIGN_DEFAULT) apply_align(obj);
+    for (lv_obj_t* child : ext->children) {
+        lv_obj_spec_attr_t* child_ext = find_ext(child);
+        if (child_ext && child_ext->align != LV_ALIGN_DEFAULT) apply_align(child);
+    }
+    if (lv_obj_check_type(obj, &lv_tabview_class)) tabview_layout(obj);
+}
+
+// An explicit position replaces any alignment
+static void clear_align(lv_obj_t* obj) {
+    if (lv_obj_spec_attr_t* ext = find_ext(obj)) ext->align = LV_ALIGN_DEFAULT;
+}
+
+// An explicit size replaces sizing to content
+static void clear_content_size(lv_obj_t* obj) {
+    if (lv_obj_spec_attr_t* ext = find_ext(obj)) ext->content_size = false;
 }
 
 void lv_obj_set_pos(lv_obj_t* obj, lv_coord_t x, lv_coord_t y) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     if (!obj) return;
-    lv_coord_t w = obj->coords.x2 - obj->coords.x1;
-    lv_coord_t h = obj->coords.y2 - obj->coords.y1;
-    obj->coords.x1 = x;
-    obj->coords.y1 = y;
-    obj->coords.x2 = x + w;
-    obj->coords.y2 = y + h;
+    clear_align(obj);
+    set_coords(obj, x, y, lv_obj_get_width(obj), lv_obj_get_height(obj));
 }
 
 void lv_obj_set_x(lv_obj_t* obj, lv_coord_t x) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     if (!obj) return;
-    lv_coord_t w = obj->coords.x2 - obj->coords.x1;
-    obj->coords.x1 = x;
-    obj->coords.x2 = x + w;
+    clear_align(obj);
+    set_coords(obj, x, obj->coords.y1, lv_obj_get_width(obj), lv_obj_get_height(obj));
 }
 
 void lv_obj_set_y(lv_obj_t* obj, lv_coord_t y) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     if (!obj) return;
-    lv_coord_t h = obj->coords.y2 - obj->coords.y1;
-    obj->coords.y1 = y;
-    obj->coords.y2 = y + h;
+    clear_align(obj);
+    set_coords(obj, obj->coords.x1, y, lv_obj_get_width(obj), lv_obj_get_height(obj));
 }
 
 void lv_obj_set_size(lv_obj_t* obj, lv_coord_t w, lv_coord_t h) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     if (!obj) return;
-    obj->coords.x2 = obj->coords.x1 + w;
-    obj->coords.y2 = obj->coords.y1 + h;
+    clear_content_size(obj);
+    set_coords(obj, obj->coords.x1, obj->coords.y1, w, h);
 }
 
 void lv_obj_set_width(lv_obj_t* obj, lv_coord_t w) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     if (!obj) return;
-    obj->coords.x2 = obj->coords.x1 + w;
+    clear_content_size(obj);
+    set_coords(obj, obj->coords.x1, obj->coords.y1, w, lv_obj_get_height(obj));
 }
 
 void lv_obj_set_height(lv_obj_t* obj, lv_coord_t h) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     if (!obj) return;
-    obj->coords.y2 = obj->coords.y1 + h;
+    clear_content_size(obj);
+    set_coords(obj, obj->coords.x1, obj->coords.y1, lv_obj_get_width(obj), h);
 }
 
 void lv_obj_set_align(lv_obj_t* obj, lv_align_t align) {
-    (void)obj;
-    (void)align;
-    // Would set alignment in full implementation
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    lv_obj_align(obj, align, 0, 0);
 }
 
-void lv_obj_align(lv_obj_t* obj, lv_align_t align, lv_coord_t x_ofs, lv_coord_t y_ofs) {
-    if (!obj || !obj->parent) return;
-    
+static void apply_align(lv_obj_t* obj) {
+    const lv_obj_spec_attr_t* ext = find_ext(obj);
+    if (!ext || !obj->parent) return;
+
     lv_coord_t pw = obj->parent->coords.x2 - obj->parent->coords.x1;
     lv_coord_t ph = obj->parent->coords.y2 - obj->parent->coords.y1;
     lv_coord_t w = obj->coords.x2 - obj->coords.x1;
     lv_coord_t h = obj->coords.y2 - obj->coords.y1;
-    
+
     lv_coord_t x = 0, y = 0;
-    
-    switch (align) {
+
+    switch (ext->align) {
         case LV_ALIGN_TOP_LEFT: x = 0; y = 0; break;
         case LV_ALIGN_TOP_MID: x = (pw - w) / 2; y = 0; break;
         case LV_ALIGN_TOP_RIGHT: x = pw - w; y = 0; break;
@@ -408,188 +1167,511 @@ void lv_obj_align(lv_obj_t* obj, lv_align_t align, lv_coord_t x_ofs, lv_coord_t
         case LV_ALIGN_CENTER: x = (pw - w) / 2; y = (ph - h) / 2; break;
         default: break;
     }
-    
-    lv_obj_set_pos(obj, x + x_ofs, y + y_ofs);
+
+    set_coords(obj, x + ext->align_x, y + ext->align_y, w, h);
+}
+
+void lv_obj_align(lv_obj_t* obj, lv_align_t align, lv_coord_t x_ofs, lv_coord_t y_ofs) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!obj || !obj->parent) return;
+
+    lv_obj_spec_attr_t& ext = *obj->spec_attr;
+    ext.align = align;
+    ext.align_x = x_ofs;
+    ext.align_y = y_ofs;
+    apply_align(obj);
 }
 
 void lv_obj_align_to(lv_obj_t* obj, const lv_obj_t* base, lv_align_t align, lv_coord_t x_ofs, lv_coord_t y_ofs) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     (void)base;
     lv_obj_align(obj, align, x_ofs, y_ofs);
 }
 
 void lv_obj_center(lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     lv_obj_align(obj, LV_ALIGN_CENTER, 0, 0);
 }
 
 lv_coord_t lv_obj_get_x(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return 0;
     return obj ? obj->coords.x1 : 0;
 }
 
 lv_coord_t lv_obj_get_y(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return 0;
     return obj ? obj->coords.y1 : 0;
 }
 
 lv_coord_t lv_obj_get_width(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return 0;
     return obj ? (obj->coords.x2 - obj->coords.x1) : 0;
 }
 
 lv_coord_t lv_obj_get_height(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return 0;
     return obj ? (obj->coords.y2 - obj->coords.y1) : 0;
 }
 
 void lv_obj_add_flag(lv_obj_t* obj, lv_obj_flag_t f) {
-    if (obj) obj->flags |= f;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!obj) return;
+    if (f & LV_OBJ_FLAG_HIDDEN) lv_obj_invalidate(obj);
+    obj->flags |= f;
 }
 
 void lv_obj_clear_flag(lv_obj_t* obj, lv_obj_flag_t f) {
-    if (obj) obj->flags &= ~f;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!obj) return;
+    obj->flags &= ~f;
+    if (f & LV_OBJ_FLAG_HIDDEN) lv_obj_invalidate(obj);
 }
 
 bool lv_obj_has_flag(const lv_obj_t* obj, lv_obj_flag_t f) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return false;
     return obj ? (obj->flags & f) != 0 : false;
 }
 
 void lv_obj_add_state(lv_obj_t* obj, lv_state_t state) {
-    if (obj) obj->state |= state;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!obj || (obj->state & state) == state) return;
+    obj->state |= state;
+    lv_obj_invalidate(obj);
 }
 
 void lv_obj_clear_state(lv_obj_t* obj, lv_state_t state) {
-    if (obj) obj->state &= ~state;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!obj || (obj->state & state) == 0) return;
+    obj->state &= ~state;
+    lv_obj_invalidate(obj);
 }
 
 lv_state_t lv_obj_get_state(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return LV_STATE_DEFAULT;
     return obj ? static_cast<lv_state_t>(obj->state) : LV_STATE_DEFAULT;
 }
 
 bool lv_obj_has_state(const lv_obj_t* obj, lv_state_t state) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return false;
     return obj ? (obj->state & state) != 0 : false;
 }
 
-// Event handling - simplified
-struct event_cb_entry {
-    lv_obj_t* obj;
-    lv_event_cb_t cb;
-    lv_event_code_t filter;
-    void* user_data;
-};
-static std::vector<event_cb_entry> event_callbacks;
-
 void lv_obj_add_event_cb(lv_obj_t* obj, lv_event_cb_t event_cb, lv_event_code_t filter, void* user_data) {
-    event_callbacks.push_back({obj, event_cb, filter, user_data});
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!obj) return;
+    obj->spec_attr->events.push_back({event_cb, filter, user_data});
 }
 
 bool lv_obj_remove_event_cb(lv_obj_t* obj, lv_event_cb_t event_cb) {
-    auto it = std::find_if(event_callbacks.begin(), event_callbacks.end(),
-        [obj, event_cb](const event_cb_entry& e) { return e.obj == obj && e.cb == event_cb; });
-    if (it != event_callbacks.end()) {
-        event_callbacks.erase(it);
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return false;
+    if (!obj) return false;
+    std::vector<event_cb_entry>& events = obj->spec_attr->events;
+    auto it = std::find_if(events.begin(), events.end(),
+        [event_cb](const event_cb_entry& e) { return e.cb == event_cb; });
+    if (it != events.end()) {
+        events.erase(it);
         return true;
     }
     return false;
 }
 
 void lv_obj_set_user_data(lv_obj_t* obj, void* user_data) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     if (obj) obj->user_data = user_data;
 }
 
 void* lv_obj_get_user_data(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return nullptr;
     return obj ? obj->user_data : nullptr;
 }
 
 lv_obj_t* lv_obj_get_parent(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return nullptr;
     return obj ? obj->parent : nullptr;
 }
 
 lv_obj_t* lv_obj_get_child(const lv_obj_t* obj, int32_t id) {
-    (void)obj;
-    (void)id;
-    return nullptr; // Simplified - no child tracking
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return nullptr;
+    const lv_obj_spec_attr_t* ext = find_ext(obj);
+    if (!ext) return nullptr;
+    int32_t count = static_cast<int32_t>(ext->children.size());
+    if (id < 0) id += count;  // Negative ids count from the end
+    return id >= 0 && id < count ? ext->children[id] : nullptr;
 }
 
 uint32_t lv_obj_get_child_cnt(const lv_obj_t* obj) {
-    (void)obj;
-    return 0; // Simplified
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return 0;
+    const lv_obj_spec_attr_t* ext = find_ext(obj);
+    return ext ? static_cast<uint32_t>(ext->children.size()) : 0;
 }
 
 /*====================
  * STYLE FUNCTIONS
  *====================*/
 
+// Property/value pair stored in lv_style_t::values
+struct style_prop_t {
+    lv_style_prop_t prop;
+    lv_style_value_t value;
+};
+
+static size_t style_bytes(const lv_style_t* style) {
+    return style->prop_cnt * sizeof(style_prop_t);
+}
+
 void lv_style_init(lv_style_t* style) {
+    LvglLock lock(host::lvgl_mutex());
     if (style) memset(style, 0, sizeof(lv_style_t));
 }
 
 void lv_style_reset(lv_style_t* style) {
+    LvglLock lock(host::lvgl_mutex());
+    if (!style) return;
+    delete[] static_cast<style_prop_t*>(style->values);
     lv_style_init(style);
 }
 
-void lv_style_set_width(lv_style_t* style, lv_coord_t value) { (void)style; (void)value; }
-void lv_style_set_height(lv_style_t* style, lv_coord_t value) { (void)style; (void)value; }
-void lv_style_set_bg_color(lv_style_t* style, lv_color_t color) { (void)style; (void)color; }
-void lv_style_set_bg_opa(lv_style_t* style, lv_opa_t value) { (void)style; (void)value; }
-void lv_style_set_text_color(lv_style_t* style, lv_color_t color) { (void)style; (void)color; }
-void lv_style_set_text_font(lv_style_t* style, const lv_font_t* font) { (void)style; (void)font; }
-void lv_style_set_border_width(lv_style_t* style, lv_coord_t value) { (void)style; (void)value; }
-void lv_style_set_border_color(lv_style_t* style, lv_color_t color) { (void)style; (void)color; }
-void lv_style_set_radius(lv_style_t* style, lv_coord_t value) { (void)style; (void)value; }
-void lv_style_set_pad_all(lv_style_t* style, lv_coord_t value) { (void)style; (void)value; }
-void lv_style_set_pad_top(lv_style_t* style, lv_coord_t value) { (void)style; (void)value; }
-void lv_style_set_pad_bottom(lv_style_t* style, lv_coord_t value) { (void)style; (void)value; }
-void lv_style_set_pad_left(lv_style_t* style, lv_coord_t value) { (void)style; (void)value; }
-void lv_style_set_pad_right(lv_style_t* style, lv_coord_t value) { (void)style; (void)value; }
-
-void lv_obj_add_style(lv_obj_t* obj, lv_style_t* style, lv_style_selector_t selector) { (void)obj; (void)style; (void)selector; }
-void lv_obj_remove_style(lv_obj_t* obj, lv_style_t* style, lv_style_selector_t selector) { (void)obj; (void)style; (void)selector; }
-void lv_obj_remove_style_all(lv_obj_t* obj) { (void)obj; }
-
-void lv_obj_set_style_bg_color(lv_obj_t* obj, lv_color_t color, lv_style_selector_t selector) { (void)obj; (void)color; (void)selector; }
-void lv_obj_set_style_bg_opa(lv_obj_t* obj, lv_opa_t value, lv_style_selector_t selector) { (void)obj; (void)value; (void)selector; }
-void lv_obj_set_style_text_color(lv_obj_t* obj, lv_color_t color, lv_style_selector_t selector) { (void)obj; (void)color; (void)selector; }
-void lv_obj_set_style_border_width(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { (void)obj; (void)value; (void)selector; }
-void lv_obj_set_style_border_color(lv_obj_t* obj, lv_color_t color, lv_style_selector_t selector) { (void)obj; (void)color; (void)selector; }
-void lv_obj_set_style_radius(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { (void)obj; (void)value; (void)selector; }
-void lv_obj_set_style_pad_all(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { (void)obj; (void)value; (void)selector; }
-void lv_obj_set_style_pad_top(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { (void)obj; (void)value; (void)selector; }
-void lv_obj_set_style_pad_bottom(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { (void)obj; (void)value; (void)selector; }
-void lv_obj_set_style_pad_left(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { (void)obj; (void)value; (void)selector; }
-void lv_obj_set_style_pad_right(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { (void)obj; (void)value; (void)selector; }
+void lv_style_set_prop(lv_style_t* style, lv_style_prop_t prop, lv_style_value_t value) {
+    LvglLock lock(host::lvgl_mutex());
+    if (!style) return;
+    style_prop_t* props = static_cast<style_prop_t*>(style->values);
+    for (uint16_t i = 0; i < style->prop_cnt; i++) {
+        if (props[i].prop == prop) {
+            props[i].value = value;
+            return;
+        }
+    }
+
+    style_prop_t* grown = new style_prop_t[style->prop_cnt + 1];
+    std::copy(props, props + style->prop_cnt, grown);
+    grown[style->prop_cnt] = {prop, value};
+    delete[] props;
+    style->values = grown;
+    style->prop_cnt++;
+}
+
+bool lv_style_get_prop(const lv_style_t* style, lv_style_prop_t prop, lv_style_value_t* value) {
+    LvglLock lock(host::lvgl_mutex());
+    if (!style) return false;
+    const style_prop_t* props = static_cast<const style_prop_t*>(style->values);
+    for (uint16_t i = 0; i < style->prop_cnt; i++) {
+        if (props[i].prop == prop) {
+            *value = props[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+void lv_style_set_width(lv_style_t* style, lv_coord_t value) { lv_style_set_prop(style, LV_STYLE_WIDTH, num_value(value)); }
+void lv_style_set_height(lv_style_t* style, lv_coord_t value) { lv_style_set_prop(style, LV_STYLE_HEIGHT, num_value(value)); }
+void lv_style_set_bg_color(lv_style_t* style, lv_color_t color) { lv_style_set_prop(style, LV_STYLE_BG_COLOR, color_value(color)); }
+void lv_style_set_bg_opa(lv_style_t* style, lv_opa_t value) { lv_style_set_prop(style, LV_STYLE_BG_OPA, num_value(value)); }
+void lv_style_set_text_color(lv_style_t* style, lv_color_t color) { lv_style_set_prop(style, LV_STYLE_TEXT_COLOR, color_value(color)); }
+void lv_style_set_text_font(lv_style_t* style, const lv_font_t* font) { lv_style_set_prop(style, LV_STYLE_TEXT_FONT, ptr_value(font)); }
+void lv_style_set_border_width(lv_style_t* style, lv_coord_t value) { lv_style_set_prop(style, LV_STYLE_BORDER_WIDTH, num_value(value)); }
+void lv_style_set_border_color(lv_style_t* style, lv_color_t color) { lv_style_set_prop(style, LV_STYLE_BORDER_COLOR, color_value(color)); }
+void lv_style_set_radius(lv_style_t* style, lv_coord_t value) { lv_style_set_prop(style, LV_STYLE_RADIUS, num_value(value)); }
+void lv_style_set_pad_top(lv_style_t* style, lv_coord_t value) { lv_style_set_prop(style, LV_STYLE_PAD_TOP, num_value(value)); }
+void lv_style_set_pad_bottom(lv_style_t* style, lv_coord_t value) { lv_style_set_prop(style, LV_STYLE_PAD_BOTTOM, num_value(value)); }
+void lv_style_set_pad_left(lv_style_t* style, lv_coord_t value) { lv_style_set_prop(style, LV_STYLE_PAD_LEFT, num_value(value)); }
+void lv_style_set_pad_right(lv_style_t* style, lv_coord_t value) { lv_style_set_prop(style, LV_STYLE_PAD_RIGHT, num_value(value)); }
+
+void lv_style_set_pad_all(lv_style_t* style, lv_coord_t value) {
+    LvglLock lock(host::lvgl_mutex());
+    lv_style_set_pad_top(style, value);
+    lv_style_set_pad_bottom(style, value);
+    lv_style_set_pad_left(style, value);
+    lv_style_set_pad_right(style, value);
+}
+
+void lv_obj_add_style(lv_obj_t* obj, lv_style_t* style, lv_style_selector_t selector) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!obj || !style) return;
+    obj->spec_attr->styles.push_back({style, selector, false});
+    lv_obj_invalidate(obj);
+}
+
+void lv_obj_remove_style(lv_obj_t* obj, lv_style_t* style, lv_style_selector_t selector) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    lv_obj_spec_attr_t* ext = find_ext(obj);
+    if (!ext) return;
+
+    // A null style matches every style, local ones included
+    bool any_selector = selector == (LV_PART_ANY | LV_STATE_ANY);
+    auto removed = std::remove_if(ext->styles.begin(), ext->styles.end(), [&](const obj_style_t& s) {
+        if (style ? s.style != style : false) return false;
+        if (!any_selector && s.selector != selector) return false;
+        if (s.local) {
+            lv_style_reset(s.style);
+            delete s.style;
+        }
+        return true;
+    });
+    if (removed == ext->styles.end()) return;
+    ext->styles.erase(removed, ext->styles.end());
+    lv_obj_invalidate(obj);
+}
+
+void lv_obj_remove_style_all(lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    lv_obj_remove_style(obj, nullptr, LV_PART_ANY | LV_STATE_ANY);
+}
+
+// Invalidates an object if it uses a style (any style for nullptr)
+static void invalidate_if_styled(lv_obj_t* obj, const lv_style_t* style) {
+    for (const obj_style_t& s : obj->spec_attr->styles) {
+        if (style && s.style != style) continue;
+        lv_obj_invalidate(obj);
+        return;
+    }
+}
+
+void lv_obj_report_style_change(lv_style_t* style) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    invalidate_if_styled(&screen_obj, style);
+    for (obj_slab_t* slab : obj_slabs) {
+        for (obj_slot_t& slot : slab->slots) {
+            if (slot.live) invalidate_if_styled(&slot.obj, style);
+        }
+    }
+}
+
+void lv_obj_set_local_style_prop(lv_obj_t* obj, lv_style_prop_t prop, lv_style_value_t value, lv_style_selector_t selector) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!obj) return;
+    lv_obj_spec_attr_t& ext = *obj->spec_attr;
+
+    lv_style_t* style = nullptr;
+    for (const obj_style_t& s : ext.styles) {
+        if (s.local && s.selector == selector) style = s.style;
+    }
+    if (!style) {
+        style = new lv_style_t;
+        lv_style_init(style);
+        ext.styles.push_back({style, selector, true});
+    }
+
+    lv_style_set_prop(style, prop, value);
+    lv_obj_invalidate(obj);
+}
+
+// Built-in dark theme, consulted for properties no style sets
+static constexpr uint32_t THEME_PRIMARY = 0x2196F3;
+static constexpr uint32_t THEME_CHECKED = 0x1565C0;
+static constexpr uint32_t THEME_PRESSED = 0x0D47A1;
+static constexpr uint32_t THEME_SURFACE = 0x282B30;
+static constexpr uint32_t THEME_OUTLINE = 0x3D4045;
+
+static bool theme_prop(const lv_obj_t* obj, uint32_t part, lv_style_prop_t prop, lv_style_value_t& value) {
+    const lv_obj_class_t* cls = obj->class_p ? obj->class_p : &lv_obj_class;
+    uint32_t bg = 0;
+    lv_coord_t radius = 0, border = 0, pad = 0;
+    bool white_text = false;
+
+    if (!obj->parent) {
+        // Screen
+        if (part != LV_PART_MAIN) return false;
+        bg = 0x000000;
+    } else if (cls == &lv_btn_class) {
+        if (part != LV_PART_MAIN) return false;
+        bool checked = obj->state & LV_STATE_CHECKED;
+        bg = (obj->state & LV_STATE_PRESSED) ? THEME_PRESSED : checked ? THEME_CHECKED : THEME_PRIMARY;
+        radius = 6;
+        white_text = true;
+    } else if (cls == &lv_bar_class) {
+        if (part != LV_PART_MAIN && part != LV_PART_INDICATOR) return false;
+        bg = part == LV_PART_INDICATOR ? THEME_PRIMARY : THEME_OUTLINE;
+        radius = LV_RADIUS_CIRCLE;
+    } else if (cls == &lv_btnmatrix_class) {
+        if (part == LV_PART_ITEMS) {
+            bg = (obj->state & LV_STATE_CHECKED) ? THEME_PRIMARY : THEME_OUTLINE;
+            radius = 4;
+            white_text = true;
+        } else if (part == LV_PART_MAIN) {
+            bg = THEME_SURFACE;
+            pad = 4;
+        } else {
+            return false;
+        }
+    } else if (cls == &lv_obj_class) {
+        if (part != LV_PART_MAIN) return false;
+        bg = THEME_SURFACE;
+        radius = 8;
+        border = 2;
+    } else {
+        // Labels and tabviews are see-through
+        return false;
+    }
+
+    switch (prop) {
+        case LV_STYLE_BG_COLOR: value = color_value(lv_color_hex(bg)); return true;
+        case LV_STYLE_BG_OPA: value = num_value(LV_OPA_COVER); return true;
+        case LV_STYLE_RADIUS: value = num_value(radius); return true;
+        case LV_STYLE_BORDER_WIDTH: value = num_value(border); return true;
+        case LV_STYLE_BORDER_COLOR: value = color_value(lv_color_hex(THEME_OUTLINE)); return true;
+        case LV_STYLE_PAD_TOP:
+        case LV_STYLE_PAD_BOTTOM:
+        case LV_STYLE_PAD_LEFT:
+        case LV_STYLE_PAD_RIGHT:
+        case LV_STYLE_PAD_ROW:
+        case LV_STYLE_PAD_COLUMN: value = num_value(pad); return true;
+        case LV_STYLE_TEXT_COLOR:
+            if (!white_text) return false;
+            value = color_value(lv_color_white());
+            return true;
+        default: return false;
+    }
+}
+
+lv_style_value_t lv_obj_get_style_prop(const lv_obj_t* obj, uint32_t part, lv_style_prop_t prop) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return {};
+    lv_style_value_t value = num_value(0);
+    if (!obj) return value;
+
+    // Local styles win, then the most recently added style whose state
+    // the object is in
+    if (const lv_obj_spec_attr_t* ext = find_ext(obj)) {
+        for (int local = 1; local >= 0; local--) {
+            for (auto it = ext->styles.rbegin(); it != ext->styles.rend(); ++it) {
+                if (it->local != (local == 1)) continue;
+                uint32_t sel_part = it->selector & LV_PART_ANY;
+                uint32_t sel_state = it->selector & LV_STATE_ANY;
+                if (sel_part != part || (sel_state & ~obj->state) != 0) continue;
+                if (lv_style_get_prop(it->style, prop, &value)) return value;
+            }
+        }
+    }
+    if (theme_prop(obj, part, prop, value)) return value;
+
+    // Text properties are inherited from the parent
+    if (prop == LV_STYLE_TEXT_COLOR || prop == LV_STYLE_TEXT_FONT) {
+        if (obj->parent) return lv_obj_get_style_prop(obj->parent, LV_PART_MAIN, prop);
+        return prop == LV_STYLE_TEXT_COLOR ? color_value(lv_color_white()) : ptr_value(LV_FONT_DEFAULT);
+    }
+    return value;
+}
+
+static void fit_label(lv_obj_t* obj);
+
+void lv_obj_set_style_bg_color(lv_obj_t* obj, lv_color_t color, lv_style_selector_t selector) { lv_obj_set_local_style_prop(obj, LV_STYLE_BG_COLOR, color_value(color), selector); }
+void lv_obj_set_style_bg_opa(lv_obj_t* obj, lv_opa_t value, lv_style_selector_t selector) { lv_obj_set_local_style_prop(obj, LV_STYLE_BG_OPA, num_value(value), selector); }
+void lv_obj_set_style_text_color(lv_obj_t* obj, lv_color_t color, lv_style_selector_t selector) { lv_obj_set_local_style_prop(obj, LV_STYLE_TEXT_COLOR, color_value(color), selector); }
+void lv_obj_set_style_border_width(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { lv_obj_set_local_style_prop(obj, LV_STYLE_BORDER_WIDTH, num_value(value), selector); }
+void lv_obj_set_style_border_color(lv_obj_t* obj, lv_color_t color, lv_style_selector_t selector) { lv_obj_set_local_style_prop(obj, LV_STYLE_BORDER_COLOR, color_value(color), selector); }
+void lv_obj_set_style_radius(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { lv_obj_set_local_style_prop(obj, LV_STYLE_RADIUS, num_value(value), selector); }
+void lv_obj_set_style_pad_top(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { lv_obj_set_local_style_prop(obj, LV_STYLE_PAD_TOP, num_value(value), selector); }
+void lv_obj_set_style_pad_bottom(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { lv_obj_set_local_style_prop(obj, LV_STYLE_PAD_BOTTOM, num_value(value), selector); }
+void lv_obj_set_style_pad_left(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { lv_obj_set_local_style_prop(obj, LV_STYLE_PAD_LEFT, num_value(value), selector); }
+void lv_obj_set_style_pad_right(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) { lv_obj_set_local_style_prop(obj, LV_STYLE_PAD_RIGHT, num_value(value), selector); }
+
+void lv_obj_set_style_pad_all(lv_obj_t* obj, lv_coord_t value, lv_style_selector_t selector) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    lv_obj_set_style_pad_top(obj, value, selector);
+    lv_obj_set_style_pad_bottom(obj, value, selector);
+    lv_obj_set_style_pad_left(obj, value, selector);
+    lv_obj_set_style_pad_right(obj, value, selector);
+}
+
+void lv_obj_set_style_text_font(lv_obj_t* obj, const lv_font_t* font, lv_style_selector_t selector) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    lv_obj_set_local_style_prop(obj, LV_STYLE_TEXT_FONT, ptr_value(font), selector);
+    fit_label(obj);
+}
 
 /*====================
  * WIDGET STUBS
  *====================*/
 
 lv_obj_t* lv_btn_create(lv_obj_t* parent) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return &sink_obj;
     lv_obj_t* btn = lv_obj_create(parent);
+    btn->class_p = &lv_btn_class;
     btn->flags |= LV_OBJ_FLAG_CLICKABLE;
     lv_obj_set_size(btn, 100, 40);
     return btn;
 }
 
-// Label storage (simplified)
-static std::map<lv_obj_t*, std::string> label_texts;
+// Resizes a label to fit its text unless it was given a size
+static void fit_label(lv_obj_t* obj) {
+    const lv_obj_spec_attr_t* ext = find_ext(obj);
+    if (!ext || !ext->content_size) return;
+
+    lv_point_t size;
+    lv_txt_get_size(&size, lv_label_get_text(obj), lv_obj_get_style_text_font(obj, LV_PART_MAIN),
+                    0, 0, LV_COORD_MAX, 0);
+    set_coords(obj, obj->coords.x1, obj->coords.y1, size.x, size.y);
+}
 
 lv_obj_t* lv_label_create(lv_obj_t* parent) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return &sink_obj;
     lv_obj_t* label = lv_obj_create(parent);
+    label->class_p = &lv_label_class;
     label->flags &= ~LV_OBJ_FLAG_CLICKABLE;
     label_texts[label] = "";
+    label->spec_attr->content_size = true;
+    fit_label(label);
     return label;
 }
 
 void lv_label_set_text(lv_obj_t* obj, const char* txt) {
-    if (obj && txt) label_texts[obj] = txt;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (!obj || !txt) return;
+    std::string& text = label_texts[obj];
+    if (text == txt) return;  // Status labels are often re-set every loop
+
+    text = txt;
+    lv_obj_invalidate(obj);
+    fit_label(obj);
 }
 
 void lv_label_set_text_fmt(lv_obj_t* obj, const char* fmt, ...) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     if (!obj || !fmt) return;
     char buffer[256];
     va_list args;
     va_start(args, fmt);
     vsnprintf(buffer, sizeof(buffer), fmt, args);
     va_end(args);
-    label_texts[obj] = buffer;
+    lv_label_set_text(obj, buffer);
 }
 
 void lv_label_set_text_static(lv_obj_t* obj, const char* txt) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     lv_label_set_text(obj, txt);
 }
 
@@ -597,6 +1679,8 @@ void lv_label_set_long_mode(lv_obj_t* obj, lv_label_long_mode_t mode) { (void)ob
 void lv_label_set_recolor(lv_obj_t* obj, bool en) { (void)obj; (void)en; }
 
 const char* lv_label_get_text(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return "";
     if (!obj) return "";
     auto it = label_texts.find(const_cast<lv_obj_t*>(obj));
     if (it != label_texts.end()) return it->second.c_str();
@@ -604,107 +1688,331 @@ const char* lv_label_get_text(const lv_obj_t* obj) {
 }
 
 lv_label_long_mode_t lv_label_get_long_mode(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
     (void)obj;
     return LV_LABEL_LONG_WRAP;
 }
 
-// Tabview
-struct tabview_data {
-    std::vector<lv_obj_t*> tabs;
-    uint16_t active;
-};
-static std::map<lv_obj_t*, tabview_data> tabview_map;
+// Tabview: a button matrix of tab names above (or below) a content area
+// holding one child per tab, of which only the active one is shown
+static void tabview_layout(lv_obj_t* tv) {
+    auto it = tabview_map.find(tv);
+    if (it == tabview_map.end()) return;
+    const tabview_data& data = it->second;
+
+    lv_coord_t w = lv_obj_get_width(tv);
+    lv_coord_t h = lv_obj_get_height(tv);
+    lv_coord_t bar = std::min(data.tab_size, h);
+    bool bottom = data.tab_pos == LV_DIR_BOTTOM;
+    if (data.btns) set_coords(data.btns, 0, bottom ? h - bar : 0, w, bar);
+    if (data.content) set_coords(data.content, 0, bottom ? 0 : bar, w, h - bar);
+    for (lv_obj_t* tab : data.tabs) {
+        set_coords(tab, 0, 0, w, h - bar);
+    }
+}
+
+// Rebuilds the tab buttons from the names. Adding or removing a name may
+// move the others, so the whole map is redone
+static void tabview_set_map(tabview_data& data) {
+    data.map.clear();
+    for (const std::string& n : data.names) {
+        data.map.push_back(n.c_str());
+    }
+    data.map.push_back("");
+    if (!data.btns) return;
+    lv_btnmatrix_set_map(data.btns, data.map.data());
+    lv_btnmatrix_set_btn_ctrl(data.btns, data.active, LV_BTNMATRIX_CTRL_CHECKED);
+}
+
+// Drops a deleted tab, button matrix or content area from its tab view, so
+// the tab view never touches it again
+static void tabview_forget(lv_obj_t* obj) {
+    lv_obj_t* parent = obj->parent;
+    if (!parent) return;
+
+    // The button matrix and content area are children of the tab view
+    auto part = tabview_map.find(parent);
+    if (part != tabview_map.end()) {
+        if (part->second.btns == obj) part->second.btns = nullptr;
+        if (part->second.content == obj) part->second.content = nullptr;
+        return;
+    }
+
+    // Tabs are children of the content area
+    auto owner = tabview_map.find(parent->parent);
+    if (owner == tabview_map.end() || owner->second.content != parent) return;
+    tabview_data& data = owner->second;
+    auto it = std::find(data.tabs.begin(), data.tabs.end(), obj);
+    if (it == data.tabs.end()) return;
+    size_t id = static_cast<size_t>(it - data.tabs.begin());
+    data.tabs.erase(it);
+    data.names.erase(data.names.begin() + static_cast<std::ptrdiff_t>(id));
+
+    // The tab after a deleted active one (or the new last tab) takes over
+    if (id < data.active || data.active >= data.tabs.size()) {
+        data.active = data.active > 0 ? static_cast<uint16_t>(data.active - 1) : 0;
+    }
+    if (!data.tabs.empty()) lv_obj_clear_flag(data.tabs[data.active], LV_OBJ_FLAG_HIDDEN);
+    tabview_set_map(data);
+}
 
 lv_obj_t* lv_tabview_create(lv_obj_t* parent, lv_dir_t tab_pos, lv_coord_t tab_size) {
-    (void)tab_pos;
-    (void)tab_size;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return &sink_obj;
     lv_obj_t* tv = lv_obj_create(parent);
-    tabview_map[tv] = {{}, 0};
+    tv->class_p = &lv_tabview_class;
+
+    tabview_data& data = tabview_map[tv];
+    data.tab_pos = tab_pos;
+    data.tab_size = tab_size;
+    data.btns = lv_btnmatrix_create(tv);
+    data.content = lv_obj_create(tv);
+
+    // Tab buttons sit edge to edge; the content area is see-through
+    lv_obj_set_style_pad_all(data.btns, 0, LV_PART_MAIN);
+    lv_obj_set_local_style_prop(data.btns, LV_STYLE_PAD_COLUMN, num_value(0), LV_PART_MAIN);
+    lv_obj_set_style_radius(data.btns, 0, LV_PART_ITEMS);
+    lv_obj_set_style_bg_opa(data.content, LV_OPA_TRANSP, LV_PART_MAIN);
+    lv_obj_set_style_border_width(data.content, 0, LV_PART_MAIN);
+
     lv_obj_set_size(tv, 480, 272);
     return tv;
 }
 
 lv_obj_t* lv_tabview_add_tab(lv_obj_t* tv, const char* name) {
-    if (!tv) return nullptr;
-    lv_obj_t* tab = lv_obj_create(tv);
-    lv_obj_set_size(tab, 480, 222); // Below tab buttons
-    label_texts[tab] = name ? name : "";
-    tabview_map[tv].tabs.push_back(tab);
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return &sink_obj;
+    auto it = tabview_map.find(tv);
+    if (it == tabview_map.end() || !it->second.content) return nullptr;
+    tabview_data& data = it->second;
+
+    lv_obj_t* tab = lv_obj_create(data.content);
+    lv_obj_set_style_bg_opa(tab, LV_OPA_TRANSP, LV_PART_MAIN);
+    lv_obj_set_style_border_width(tab, 0, LV_PART_MAIN);
+    if (!data.tabs.empty()) lv_obj_add_flag(tab, LV_OBJ_FLAG_HIDDEN);
+    data.tabs.push_back(tab);
+    data.names.push_back(name ? name : "");
+    tabview_set_map(data);
+
+    tabview_layout(tv);
     return tab;
 }
 
 void lv_tabview_set_act(lv_obj_t* tv, uint32_t id, int anim_type) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
     (void)anim_type;
-    if (tv) tabview_map[tv].active = id;
+    auto it = tabview_map.find(tv);
+    if (it == tabview_map.end()) return;
+    tabview_data& data = it->second;
+    if (id >= data.tabs.size() || id == data.active) return;
+
+    lv_obj_add_flag(data.tabs[data.active], LV_OBJ_FLAG_HIDDEN);
+    lv_obj_clear_flag(data.tabs[id], LV_OBJ_FLAG_HIDDEN);
+    lv_btnmatrix_clear_btn_ctrl(data.btns, data.active, LV_BTNMATRIX_CTRL_CHECKED);
+    lv_btnmatrix_set_btn_ctrl(data.btns, static_cast<uint16_t>(id), LV_BTNMATRIX_CTRL_CHECKED);
+    data.active = static_cast<uint16_t>(id);
 }
 
 uint16_t lv_tabview_get_tab_act(lv_obj_t* tv) {
-    if (!tv) return 0;
-    return tabview_map[tv].active;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return 0;
+    auto it = tabview_map.find(tv);
+    return it != tabview_map.end() ? it->second.active : 0;
 }
 
 lv_obj_t* lv_tabview_get_content(lv_obj_t* tv) {
-    return tv;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return &sink_obj;
+    auto it = tabview_map.find(tv);
+    return it != tabview_map.end() ? it->second.content : nullptr;
 }
 
 lv_obj_t* lv_tabview_get_tab_btns(lv_obj_t* tv) {
-    return tv;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return &sink_obj;
+    auto it = tabview_map.find(tv);
+    return it != tabview_map.end() ? it->second.btns : nullptr;
 }
 
 // Button matrix
-static std::map<lv_obj_t*, std::vector<std::string>> btnm_maps;
-static std::map<lv_obj_t*, uint16_t> btnm_selected;
+static btnmatrix_data* find_btnm(const lv_obj_t* obj) {
+    auto it = btnm_map.find(obj);
+    return it != btnm_map.end() ? &it->second : nullptr;
+}
 
 lv_obj_t* lv_btnmatrix_create(lv_obj_t* parent) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return &sink_obj;
     lv_obj_t* btnm = lv_obj_create(parent);
-    btnm_maps[btnm] = {};
-    btnm_selected[btnm] = 0;
+    btnm->class_p = &lv_btnmatrix_class;
+    btnm_map[btnm] = btnmatrix_data();
     return btnm;
 }
 
 void lv_btnmatrix_set_map(lv_obj_t* obj, const char* map[]) {
-    if (!obj || !map) return;
-    btnm_maps[obj].clear();
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    btnmatrix_data* data = find_btnm(obj);
+    if (!data || !map) return;
+
+    // Like LVGL, the map itself must stay valid while the matrix uses it
+    data->map = map;
+    data->texts.clear();
     for (int i = 0; map[i] && map[i][0] != '\0'; i++) {
-        btnm_maps[obj].push_back(map[i]);
+        if (strcmp(map[i], "\n") != 0) data->texts.push_back(map[i]);
     }
+    data->ctrls.assign(data->texts.size(), 0);
+    lv_obj_invalidate(obj);
 }
 
-void lv_btnmatrix_set_ctrl_map(lv_obj_t* obj, const lv_btnmatrix_ctrl_t ctrl_map[]) { (void)obj; (void)ctrl_map; }
-void lv_btnmatrix_set_btn_ctrl(lv_obj_t* obj, uint16_t btn_id, lv_btnmatrix_ctrl_t ctrl) { (void)obj; (void)btn_id; (void)ctrl; }
-void lv_btnmatrix_clear_btn_ctrl(lv_obj_t* obj, uint16_t btn_id, lv_btnmatrix_ctrl_t ctrl) { (void)obj; (void)btn_id; (void)ctrl; }
-void lv_btnmatrix_set_btn_ctrl_all(lv_obj_t* obj, lv_btnmatrix_ctrl_t ctrl) { (void)obj; (void)ctrl; }
-void lv_btnmatrix_clear_btn_ctrl_all(lv_obj_t* obj, lv_btnmatrix_ctrl_t ctrl) { (void)obj; (void)ctrl; }
-void lv_btnmatrix_set_one_checked(lv_obj_t* obj, bool en) { (void)obj; (void)en; }
+void lv_btnmatrix_set_ctrl_map(lv_obj_t* obj, const lv_btnmatrix_ctrl_t ctrl_map[]) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    btnmatrix_data* data = find_btnm(obj);
+    if (!data || !ctrl_map) return;
+    for (size_t i = 0; i < data->ctrls.size(); i++) {
+        data->ctrls[i] = static_cast<uint16_t>(ctrl_map[i]);
+    }
+    lv_obj_invalidate(obj);
+}
+
+void lv_btnmatrix_set_btn_ctrl(lv_obj_t* obj, uint16_t btn_id, lv_btnmatrix_ctrl_t ctrl) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    btnmatrix_data* data = find_btnm(obj);
+    if (!data || btn_id >= data->ctrls.size()) return;
+    if (data->one_checked && (ctrl & LV_BTNMATRIX_CTRL_CHECKED)) {
+        for (uint16_t& c : data->ctrls) c &= ~LV_BTNMATRIX_CTRL_CHECKED;
+    }
+    data->ctrls[btn_id] |= ctrl;
+    lv_obj_invalidate(obj);
+}
+
+void lv_btnmatrix_clear_btn_ctrl(lv_obj_t* obj, uint16_t btn_id, lv_btnmatrix_ctrl_t ctrl) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    btnmatrix_data* data = find_btnm(obj);
+    if (!data || btn_id >= data->ctrls.size()) return;
+    data->ctrls[btn_id] &= ~ctrl;
+    lv_obj_invalidate(obj);
+}
+
+void lv_btnmatrix_set_btn_ctrl_all(lv_obj_t* obj, lv_btnmatrix_ctrl_t ctrl) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    btnmatrix_data* data = find_btnm(obj);
+    if (!data) return;
+    for (uint16_t i = 0; i < data->ctrls.size(); i++) {
+        lv_btnmatrix_set_btn_ctrl(obj, i, ctrl);
+    }
+}
+
+void lv_btnmatrix_clear_btn_ctrl_all(lv_obj_t* obj, lv_btnmatrix_ctrl_t ctrl) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    btnmatrix_data* data = find_btnm(obj);
+    if (!data) return;
+    for (uint16_t i = 0; i < data->ctrls.size(); i++) {
+        lv_btnmatrix_clear_btn_ctrl(obj, i, ctrl);
+    }
+}
+
+void lv_btnmatrix_set_one_checked(lv_obj_t* obj, bool en) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    if (btnmatrix_data* data = find_btnm(obj)) data->one_checked = en;
+}
+
+const char** lv_btnmatrix_get_map(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return nullptr;
+    const btnmatrix_data* data = find_btnm(obj);
+    return data ? data->map : nullptr;
+}
 
 uint16_t lv_btnmatrix_get_selected_btn(const lv_obj_t* obj) {
-    if (!obj) return 0;
-    auto it = btnm_selected.find(const_cast<lv_obj_t*>(obj));
-    return it != btnm_selected.end() ? it->second : 0;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return 0;
+    const btnmatrix_data* data = find_btnm(obj);
+    return data ? data->selected : 0;
 }
 
 const char* lv_btnmatrix_get_btn_text(const lv_obj_t* obj, uint16_t btn_id) {
-    if (!obj) return "";
-    auto it = btnm_maps.find(const_cast<lv_obj_t*>(obj));
-    if (it != btnm_maps.end() && btn_id < it->second.size()) {
-        return it->second[btn_id].c_str();
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return nullptr;
+    const btnmatrix_data* data = find_btnm(obj);
+    if (data && btn_id < data->texts.size()) {
+        return data->texts[btn_id].c_str();
     }
     return "";
 }
 
 bool lv_btnmatrix_has_btn_ctrl(const lv_obj_t* obj, uint16_t btn_id, lv_btnmatrix_ctrl_t ctrl) {
-    (void)obj; (void)btn_id; (void)ctrl;
-    return false;
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return false;
+    const btnmatrix_data* data = find_btnm(obj);
+    return data && btn_id < data->ctrls.size() && (data->ctrls[btn_id] & ctrl) != 0;
+}
+
+// Bar
+lv_obj_t* lv_bar_create(lv_obj_t* parent) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return &sink_obj;
+    lv_obj_t* bar = lv_obj_create(parent);
+    bar->class_p = &lv_bar_class;
+    bar_map[bar] = bar_data();
+    lv_obj_set_size(bar, 200, 10);
+    return bar;
+}
+
+void lv_bar_set_value(lv_obj_t* obj, int32_t value, int anim) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    (void)anim;
+    auto it = bar_map.find(obj);
+    if (it == bar_map.end()) return;
+    bar_data& data = it->second;
+    value = std::max(data.min, std::min(data.max, value));
+    if (value == data.value) return;
+    data.value = value;
+    lv_obj_invalidate(obj);
+}
+
+void lv_bar_set_range(lv_obj_t* obj, int32_t min, int32_t max) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return;
+    auto it = bar_map.find(obj);
+    if (it == bar_map.end() || min > max) return;
+    bar_data& data = it->second;
+    data.min = min;
+    data.max = max;
+    data.value = std::max(min, std::min(max, data.value));
+    lv_obj_invalidate(obj);
+}
+
+int32_t lv_bar_get_value(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return 0;
+    auto it = bar_map.find(obj);
+    return it != bar_map.end() ? it->second.value : 0;
+}
+
+int32_t lv_bar_get_min_value(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return 0;
+    auto it = bar_map.find(obj);
+    return it != bar_map.end() ? it->second.min : 0;
+}
+
+int32_t lv_bar_get_max_value(const lv_obj_t* obj) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return 0;
+    auto it = bar_map.find(obj);
+    return it != bar_map.end() ? it->second.max : 100;
 }
 
 // Other widgets - minimal stubs
-lv_obj_t* lv_bar_create(lv_obj_t* parent) { return lv_obj_create(parent); }
-void lv_bar_set_value(lv_obj_t* obj, int32_t value, int anim) { (void)obj; (void)value; (void)anim; }
-void lv_bar_set_range(lv_obj_t* obj, int32_t min, int32_t max) { (void)obj; (void)min; (void)max; }
-int32_t lv_bar_get_value(const lv_obj_t* obj) { (void)obj; return 0; }
-int32_t lv_bar_get_min_value(const lv_obj_t* obj) { (void)obj; return 0; }
-int32_t lv_bar_get_max_value(const lv_obj_t* obj) { (void)obj; return 100; }
-
 lv_obj_t* lv_slider_create(lv_obj_t* parent) { return lv_obj_create(parent); }
 void lv_slider_set_value(lv_obj_t* obj, int32_t value, int anim) { (void)obj; (void)value; (void)anim; }
 void lv_slider_set_range(lv_obj_t* obj, int32_t min, int32_t max) { (void)obj; (void)min; (void)max; }
@@ -754,6 +2062,8 @@ lv_obj_t* lv_list_add_btn(lv_obj_t* list, const void* icon, const char* txt) { (
 const char* lv_list_get_btn_text(const lv_obj_t* list, const lv_obj_t* btn) { (void)list; return lv_label_get_text(btn); }
 
 lv_obj_t* lv_msgbox_create(lv_obj_t* parent, const char* title, const char* txt, const char* btn_txts[], bool add_close_btn) {
+    LvglLock lock(host::lvgl_mutex());
+    if (lock.sink()) return &sink_obj;
     (void)title; (void)txt; (void)btn_txts; (void)add_close_btn;
     return lv_obj_create(parent);
 }
@@ -0,0 +1,459 @@
+/**
+ * @file fiber_scheduler.cpp
+ * @brief Cooperative Task Scheduler Implementation for Host Mode
+ */
+
+// macOS declares the ucontext functions only for XSI builds, which in
+// turn hide MAP_ANON unless Darwin extensions are asked for as well
+#if defined(__APPLE__) && !defined(_XOPEN_SOURCE)
+    #define _XOPEN_SOURCE 600
+    #define _DARWIN_C_SOURCE
+#endif
+
+#include "host/fiber_scheduler.hpp"
+#include "host/sim_context.hpp"
+#include "host/task_stats.hpp"
+#include <new>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <ucontext.h>
+    #include <unistd.h>
+#endif
+
+namespace host {
+
+// Saved execution state of a fiber, or of the scheduler thread itself
+struct FiberContext {
+#ifdef _WIN32
+    void* handle = nullptr;
+#else
+    char* mapping = nullptr;    // Guard page followed by the stack (null for the scheduler)
+    size_t mapping_size = 0;
+    ucontext_t registers;
+#endif
+};
+
+Fiber::Fiber() : context(new FiberContext()) {}
+
+Fiber::~Fiber() = default;
+
+#ifndef _WIN32
+// Maps a fiber stack with an inaccessible page below it, so an overflow
+// faults at once instead of overwriting whatever the heap put there
+static void map_stack(FiberContext& context, size_t stack_size) {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = page + (stack_size + page - 1) / page * page;
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    if (mprotect(mapping, page, PROT_NONE) != 0) {
+        munmap(mapping, size);
+        throw std::bad_alloc();
+    }
+
+    context.mapping = static_cast<char*>(mapping);
+    context.mapping_size = size;
+    context.registers.uc_stack.ss_sp = context.mapping + page;
+    context.registers.uc_stack.ss_size = size - page;
+}
+#endif
+
+// Scheduler whose thread this is (null on every other thread)
+static thread_local FiberScheduler* thread_scheduler = nullptr;
+
+FiberScheduler::FiberScheduler(SimContext& context)
+    : _context(context), _enabled(false), _ready_seq(0), _stop(false),
+      _started(false), _kick(false), _idle(false), _running(nullptr),
+      _switch_cpu_us(0), _scheduler_context(new FiberContext()) {}
+
+FiberScheduler::~FiberScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+        _kick = true;
+        if (_idle) {
+            _context.clock().interrupt();
+        }
+    }
+    _cv.notify_all();
+    if (_thread.joinable()) {
+        SimClock::BlockingScope blocking;
+        _thread.join();
+    }
+
+    // Fibers that never finished are dropped without unwinding their stacks
+    for (auto& fiber : _fibers) {
+        free_stack(fiber.get());
+    }
+}
+
+FiberScheduler* FiberScheduler::current() {
+    return (thread_scheduler && thread_scheduler->_running) ? thread_scheduler : nullptr;
+}
+
+Fiber* FiberScheduler::create(std::function<void()> entry, uint32_t priority, const std::string& name,
+                              void* owner) {
+    auto fiber = std::make_unique<Fiber>();
+    fiber->entry = std::move(entry);
+    fiber->name = name;
+    fiber->owner = owner;
+    fiber->priority = priority;
+
+#ifdef _WIN32
+    fiber->context->handle = CreateFiber(STACK_SIZE, &FiberScheduler::fiber_entry, fiber.get());
+#else
+    ucontext_t& registers = fiber->context->registers;
+    getcontext(&registers);
+    map_stack(*fiber->context, STACK_SIZE);
+    registers.uc_link = nullptr;
+    makecontext(&registers, &FiberScheduler::fiber_entry, 0);
+#endif
+
+    Fiber* result = fiber.get();
+    std::lock_guard<std::mutex> lock(_mutex);
+    fiber->state = FiberState::SUSPENDED;
+    _fibers.push_back(std::move(fiber));
+    return result;
+}
+
+void FiberScheduler::start(Fiber* fiber) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    make_ready_locked(fiber);
+
+    if (!_started) {
+        _started = true;
+        _context.clock().reserve();
+        _thread = std::thread(&FiberScheduler::run, this);
+    }
+
+    // A higher-priority task created by a running one takes over at once
+    preempt_if_outranked(lock);
+}
+
+void FiberScheduler::release(Fiber* fiber) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (fiber == _running) return;  // Freed with the scheduler instead
+
+    for (auto it = _fibers.begin(); it != _fibers.end(); ++it) {
+        if (it->get() == fiber) {
+            free_stack(fiber);
+            _fibers.erase(it);
+            return;
+        }
+    }
+}
+
+void FiberScheduler::sleep_until(uint64_t deadline_us) {
+    if (deadline_us <= _context.clock().now_us()) {
+        yield();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _running->state = FiberState::SLEEPING;
+    _running->wake_us = deadline_us;
+    switch_to_scheduler(lock);
+}
+
+void FiberScheduler::yield() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    make_ready_locked(_running);
+    switch_to_scheduler(lock);
+}
+
+bool FiberScheduler::block(uint64_t deadline_us) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    Fiber* self = _running;
+    if (self->wake_pending) {
+        self->wake_pending = false;
+        return true;
+    }
+
+    self->state = FiberState::BLOCKED;
+    self->wake_us = deadline_us;
+    self->timed_out = false;
+    switch_to_scheduler(lock);
+    return !self->timed_out;
+}
+
+void FiberScheduler::wake(Fiber* fiber) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (fiber->state == FiberState::BLOCKED) {
+        fiber->timed_out = false;
+        make_ready_locked(fiber);
+        preempt_if_outranked(lock);
+    } else if (fiber->state == FiberState::RUNNING || fiber->state == FiberState::READY) {
+        fiber->wake_pending = true;
+    }
+}
+
+void FiberScheduler::suspend(Fiber* fiber) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (on_fiber(fiber)) {
+        fiber->state = FiberState::SUSPENDED;
+        switch_to_scheduler(lock);
+    } else if (fiber->state == FiberState::RUNNING) {
+        fiber->suspend_pending = true;
+    } else if (fiber->state != FiberState::FINISHED) {
+        fiber->state = FiberState::SUSPENDED;
+    }
+}
+
+void FiberScheduler::resume(Fiber* fiber) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    fiber->suspend_pending = false;
+    if (fiber->state == FiberState::SUSPENDED) {
+        fiber->timed_out = true;
+        make_ready_locked(fiber);
+        preempt_if_outranked(lock);
+    }
+}
+
+void FiberScheduler::remove(Fiber* fiber) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (fiber->state == FiberState::FINISHED) return;
+
+    if (on_fiber(fiber)) {
+        finish_locked(fiber);
+        switch_to_scheduler(lock);  // Never switched back to
+    } else if (fiber->state == FiberState::RUNNING) {
+        fiber->remove_pending = true;
+    } else {
+        finish_locked(fiber);
+        free_stack(fiber);
+    }
+}
+
+void FiberScheduler::set_priority(Fiber* fiber, uint32_t priority) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    fiber->priority = priority;
+    preempt_if_outranked(lock);
+}
+
+void FiberScheduler::join(Fiber* fiber) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (thread_scheduler == this && _running) {
+        Fiber* self = _running;
+        while (fiber->state != FiberState::FINISHED) {
+            fiber->joiners.push_back(self);
+            self->state = FiberState::BLOCKED;
+            self->wake_us = 0;
+            switch_to_scheduler(lock);
+        }
+        return;
+    }
+
+    // Joining from an ordinary thread
+    lock.unlock();
+    SimClock::BlockingScope blocking;
+    lock.lock();
+    _finished.wait(lock, [&]() { return fiber->state == FiberState::FINISHED || _stop; });
+}
+
+FiberState FiberScheduler::state(Fiber* fiber) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return fiber->state;
+}
+
+void FiberScheduler::run() {
+    SimContext::Scope scope(_context);
+    SimClock& clock = _context.clock();
+    clock.attach_reserved();
+    thread_scheduler = this;
+#ifdef _WIN32
+    _scheduler_context->handle = ConvertThreadToFiber(nullptr);
+#endif
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stop) {
+        _kick = false;
+
+        // Wake sleepers that are due and find the next deadline
+        uint64_t now = clock.now_us();
+        uint64_t next = 0;
+        for (auto& entry : _fibers) {
+            Fiber* fiber = entry.get();
+            bool waiting = fiber->state == FiberState::SLEEPING || fiber->state == FiberState::BLOCKED;
+            if (!waiting || fiber->wake_us == 0) continue;
+
+            if (fiber->wake_us <= now) {
+                fiber->timed_out = fiber->state == FiberState::BLOCKED;
+                make_ready_locked(fiber);
+            } else if (next == 0 || fiber->wake_us < next) {
+                next = fiber->wake_us;
+            }
+        }
+
+        Fiber* fiber = pick_ready_locked();
+        if (fiber) {
+            switch_to_fiber(fiber, lock);
+
+            // Apply what other threads asked for while it ran
+            if (fiber->state != FiberState::FINISHED) {
+                if (fiber->remove_pending) {
+                    finish_locked(fiber);
+                } else if (fiber->suspend_pending) {
+                    fiber->suspend_pending = false;
+                    fiber->state = FiberState::SUSPENDED;
+                }
+            }
+            if (fiber->state == FiberState::FINISHED) {
+                free_stack(fiber);
+            }
+            continue;
+        }
+
+        // Nothing to run: wait for the next deadline or for another thread
+        // to make a fiber ready
+        if (next) {
+            _idle = true;
+            lock.unlock();
+            clock.sleep_until(next, _kick);
+            lock.lock();
+            _idle = false;
+        } else {
+            lock.unlock();
+            {
+                SimClock::BlockingScope blocking;
+                lock.lock();
+                _cv.wait(lock, [&]() { return _kick || _stop; });
+                lock.unlock();
+            }
+            lock.lock();
+        }
+    }
+    _finished.notify_all();
+    lock.unlock();
+
+#ifdef _WIN32
+    ConvertFiberToThread();
+#endif
+    thread_scheduler = nullptr;
+    clock.detach();
+}
+
+Fiber* FiberScheduler::pick_ready_locked() {
+    Fiber* best = nullptr;
+    for (auto& entry : _fibers) {
+        Fiber* fiber = entry.get();
+        if (fiber->state != FiberState::READY) continue;
+        if (!best || fiber->priority > best->priority ||
+            (fiber->priority == best->priority && fiber->ready_seq < best->ready_seq)) {
+            best = fiber;
+        }
+    }
+    return best;
+}
+
+void FiberScheduler::make_ready_locked(Fiber* fiber) {
+    fiber->state = FiberState::READY;
+    fiber->wake_us = 0;
+    fiber->ready_seq = ++_ready_seq;
+    _kick = true;
+    _cv.notify_one();
+    if (_idle) {
+        _context.clock().interrupt();
+    }
+}
+
+void FiberScheduler::finish_locked(Fiber* fiber) {
+    fiber->state = FiberState::FINISHED;
+    for (Fiber* joiner : fiber->joiners) {
+        if (joiner->state == FiberState::BLOCKED) {
+            joiner->timed_out = false;
+            make_ready_locked(joiner);
+        }
+    }
+    fiber->joiners.clear();
+    _finished.notify_all();
+}
+
+void FiberScheduler::free_stack(Fiber* fiber) {
+    FiberContext& context = *fiber->context;
+#ifdef _WIN32
+    if (context.handle) {
+        DeleteFiber(context.handle);
+        context.handle = nullptr;
+    }
+#else
+    if (context.mapping) {
+        munmap(context.mapping, context.mapping_size);
+        context.mapping = nullptr;
+    }
+#endif
+}
+
+bool FiberScheduler::on_fiber(Fiber* fiber) const {
+    return thread_scheduler == this && _running == fiber;
+}
+
+void FiberScheduler::preempt_if_outranked(std::unique_lock<std::mutex>& lock) {
+    if (thread_scheduler != this || !_running) return;
+
+    for (auto& entry : _fibers) {
+        if (entry->state == FiberState::READY && entry->priority > _running->priority) {
+            make_ready_locked(_running);
+            switch_to_scheduler(lock);
+            return;
+        }
+    }
+}
+
+void FiberScheduler::switch_to_scheduler(std::unique_lock<std::mutex>& lock) {
+    Fiber* self = _running;
+    lock.unlock();
+#ifdef _WIN32
+    (void)self;
+    SwitchToFiber(_scheduler_context->handle);
+#else
+    swapcontext(&self->context->registers, &_scheduler_context->registers);
+#endif
+    lock.lock();
+}
+
+void FiberScheduler::switch_to_fiber(Fiber* fiber, std::unique_lock<std::mutex>& lock) {
+    fiber->state = FiberState::RUNNING;
+    _running = fiber;
+    _switch_cpu_us = thread_cpu_time_us();
+    lock.unlock();
+#ifdef _WIN32
+    SwitchToFiber(fiber->context->handle);
+#else
+    swapcontext(&_scheduler_context->registers, &fiber->context->registers);
+#endif
+    lock.lock();
+    fiber->cpu_us += thread_cpu_time_us() - _switch_cpu_us;
+    _running = nullptr;
+}
+
+uint64_t FiberScheduler::running_cpu_us() const {
+    return _running->cpu_us + (thread_cpu_time_us() - _switch_cpu_us);
+}
+
+void FiberScheduler::fiber_main(Fiber* fiber) {
+    fiber->entry();
+    fiber->entry = nullptr;
+
+    FiberScheduler* scheduler = thread_scheduler;
+    std::unique_lock<std::mutex> lock(scheduler->_mutex);
+    if (fiber->state != FiberState::FINISHED) {
+        scheduler->finish_locked(fiber);
+    }
+    scheduler->switch_to_scheduler(lock);  // Never switched back to
+}
+
+#ifdef _WIN32
+void __stdcall FiberScheduler::fiber_entry(void* param) {
+    fiber_main(static_cast<Fiber*>(param));
+}
+#else
+void FiberScheduler::fiber_entry() {
+    fiber_main(thread_scheduler->_running);
+}
+#endif
+
+} // namespace host
@@ -4,18 +4,26 @@
  */
 
 #include "host/hal.hpp"
+#include "host/sim_clock.hpp"
+#include "host/sim_context.hpp"
 #include <algorithm>
-#include <cmath>
+#include <chrono>
+#include <iostream>
 
 namespace host {
 
-// Singleton instance
+// Physics defaults
+static constexpr double DEFAULT_PHYSICS_STEP_MS = 10.0;
+static constexpr double MAX_PHYSICS_LAG_MS = 250.0;  // Beyond this, drop time instead of catching up
+
 HAL& HAL::instance() {
-    static HAL instance;
-    return instance;
+    return SimContext::current().hal();
 }
 
-HAL::HAL() : _robot_mode(RobotMode::DISABLED), _competition_connected(false) {
+HAL::HAL()
+    : _physics_step_ms(DEFAULT_PHYSICS_STEP_MS), _physics_substeps(1), _physics_running(false),
+      _robot_mode(RobotMode::DISABLED), _competition_connected(false),
+      _lcd_buttons(0), _lcd_bg_color(0x0000), _lcd_text_color(0xFFFF), _lcd_initialized(false) {
     init();
 }
 
@@ -23,70 +31,244 @@ HAL::~HAL() {
     shutdown();
 }
 
+// Starts every port over from the given commands, with the motors at rest
+void HAL::reset_motors(const std::array<MotorState, 21>& commands) {
+    std::lock_guard<std::mutex> lanes_lock(_lanes_mutex);
+    _motor_lanes = MotorLanes();
+    for (size_t i = 0; i < _motors.size(); i++) {
+        MotorPort& motor = _motors[i];
+        std::lock_guard<std::mutex> lock(motor.write_mutex);
+        MotorState& command = motor.command;
+        command = MotorState();
+        command.voltage = commands[i].voltage;
+        command.velocity = commands[i].velocity;
+        command.gearset = commands[i].gearset;
+        command.reversed = commands[i].reversed;
+        command.connected = commands[i].connected;
+        command.temperature = _motor_lanes.temperature[i];
+        motor.position_set = false;
+        motor.refresh_limits();
+        motor.state.store(command);
+    }
+}
+
+// Copies each port's commands into the physics lanes (caller holds _lanes_mutex)
+void HAL::gather_motor_lanes() {
+    for (size_t i = 0; i < _motors.size(); i++) {
+        MotorPort& motor = _motors[i];
+        std::lock_guard<std::mutex> lock(motor.write_mutex);
+        const MotorState& command = motor.command;
+        _motor_lanes.voltage[i] = command.voltage;
+        _motor_lanes.max_velocity[i] = motor.max_velocity;
+        _motor_lanes.inv_max_velocity[i] = motor.inv_max_velocity;
+        _motor_lanes.active[i] = command.connected ? 1.0 : 0.0;
+        if (motor.position_set) {
+            _motor_lanes.position[i] = command.position;
+            motor.position_set = false;
+        }
+    }
+}
+
+// Publishes each port's physics results (caller holds _lanes_mutex)
+void HAL::scatter_motor_lanes() {
+    for (size_t i = 0; i < _motors.size(); i++) {
+        MotorPort& motor = _motors[i];
+        std::lock_guard<std::mutex> lock(motor.write_mutex);
+        MotorState& command = motor.command;
+        // A position set during the step wins; it is loaded next step
+        if (!motor.position_set) command.position = _motor_lanes.position[i];
+        command.actual_velocity = _motor_lanes.velocity[i];
+        command.current = static_cast<int32_t>(_motor_lanes.current[i]);
+        command.temperature = _motor_lanes.temperature[i];
+        motor.state.store(command);
+    }
+}
+
+void HAL::MotorPort::refresh_limits() {
+    max_velocity = motor_max_velocity(command.gearset);
+    inv_max_velocity = command.connected ? 1.0 / max_velocity : 0.0;
+}
+
+// Changes a port's commands and republishes it; the lanes pick the change
+// up at the next step
+template <typename F>
+void HAL::update_motor(uint8_t port, F&& modify) {
+    MotorPort& motor = _motors[port - 1];
+    std::lock_guard<std::mutex> lock(motor.write_mutex);
+    modify(motor.command);
+    motor.state.store(motor.command);
+}
+
+template <typename F>
+void HAL::update_controller(pros::controller_id_e_t id, F&& modify) {
+    ControllerPort& controller = _controllers[id];
+    std::lock_guard<std::mutex> lock(controller.write_mutex);
+    ControllerState state = controller.state.load();
+    modify(state);
+    controller.state.store(state);
+}
+
 void HAL::init() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    
     // Initialize motors
-    for (auto& motor : _motors) {
-        motor = MotorState();
-    }
+    reset_motors(std::array<MotorState, 21>());
     
     // Initialize controllers
-    for (auto& controller : _controllers) {
-        controller = ControllerState();
-        controller.connected = true; // Default to connected
+    for (int id = 0; id < 2; id++) {
+        update_controller(static_cast<pros::controller_id_e_t>(id), [](ControllerState& controller) {
+            controller = ControllerState();
+            controller.connected = true; // Default to connected
+        });
     }
     
     // Initialize battery
-    _battery = BatteryState();
+    {
+        std::lock_guard<std::mutex> lock(_battery_mutex);
+        _battery.store(BatteryState());
+    }
     
     // Initialize LCD
-    for (auto& line : _lcd_lines) {
-        line.clear();
+    {
+        std::lock_guard<std::mutex> lock(_lcd_mutex);
+        for (auto& line : _lcd_lines) {
+            line.clear();
+        }
     }
     _lcd_buttons = 0;
     _lcd_initialized = false;
+    
+    publish_snapshot();
+}
+
+void HAL::publish_snapshot() {
+    std::lock_guard<std::mutex> lock(_snapshot_mutex);
+    for (size_t i = 0; i < _motors.size(); i++) {
+        _motors[i].state.load(_staging.motors[i]);
+    }
+    for (size_t i = 0; i < _controllers.size(); i++) {
+        _controllers[i].state.load(_staging.controllers[i]);
+    }
+    _battery.load(_staging.battery);
+    _staging.mode = _robot_mode;
+    _staging.version++;
+    _snapshot.store(_staging);
 }
 
 void HAL::shutdown() {
-    std::lock_guard<std::mutex> lock(_mutex);
+    stop_physics();
     _robot_mode = RobotMode::DISABLED;
 }
 
-void HAL::update() {
-    std::lock_guard<std::mutex> lock(_mutex);
+void HAL::set_physics_step(double step_ms, int substeps) {
+    if (step_ms <= 0.0 || substeps < 1) return;
+    _physics_step_ms = step_ms;
+    _physics_substeps = substeps;
+}
+
+void HAL::configure_from(HAL& other) {
+    std::array<MotorState, 21> commands;
+    for (size_t i = 0; i < commands.size(); i++) {
+        commands[i] = other._motors[i].state.load();
+    }
+    reset_motors(commands);
+    set_physics_step(other._physics_step_ms, other._physics_substeps);
+    publish_snapshot();
+}
+
+void HAL::start_physics() {
+    if (_physics_running) return;
+    _physics_running = true;
     
-    // Simulate motor physics
-    for (auto& motor : _motors) {
-        if (!motor.connected) continue;
-        
-        // Calculate max velocity based on gearset
-        double max_velocity = 200.0; // Default 18:1
-        switch (motor.gearset) {
-            case pros::E_MOTOR_GEARSET_36: max_velocity = 100.0; break;
-            case pros::E_MOTOR_GEARSET_18: max_velocity = 200.0; break;
-            case pros::E_MOTOR_GEARSET_06: max_velocity = 600.0; break;
-            default: break;
+    // The physics thread steps on the clock of the context that started it
+    SimContext* context = &SimContext::current();
+    _physics_thread = std::thread([this, context]() {
+        SimContext::Scope scope(*context);
+        physics_thread();
+    });
+}
+
+void HAL::stop_physics() {
+    {
+        std::lock_guard<std::mutex> lock(_physics_mutex);
+        _physics_running = false;
+    }
+    _physics_cv.notify_all();
+    if (!_physics_thread.joinable()) return;
+    
+    // On virtual time the physics thread only wakes once every participant
+    // sleeps, and joining is not sleeping
+    SimClock::BlockingScope blocking;
+    _physics_thread.join();
+}
+
+void HAL::physics_thread() {
+    SimClock& sim_clock = SimClock::instance();
+    if (sim_clock.is_virtual()) {
+        // On virtual time the clock waits for us, so every step lands exactly
+        SimClock::Participant participant;
+        uint64_t next_us = sim_clock.now_us();
+        while (_physics_running) {
+            update();
+            next_us += static_cast<uint64_t>(_physics_step_ms * 1000.0);
+            sim_clock.sleep_until(next_us);
         }
+        return;
+    }
+    
+    using clock = std::chrono::steady_clock;
+    
+    // Fixed-timestep accumulator: run as many whole steps as wall-clock time
+    // has accumulated, so simulated time tracks real time regardless of how
+    // late this thread gets scheduled
+    clock::time_point last = clock::now();
+    double accumulator = 0.0;
+    uint64_t dropped_ms = 0;
+    
+    while (_physics_running) {
+        clock::time_point now = clock::now();
+        accumulator += std::chrono::duration<double, std::milli>(now - last).count();
+        last = now;
         
-        // Calculate target velocity from voltage
-        double target_velocity = (motor.voltage / 127.0) * max_velocity;
-        
-        // Smooth velocity change (simple first-order filter)
-        double alpha = 0.1;
-        motor.actual_velocity = motor.actual_velocity * (1.0 - alpha) + target_velocity * alpha;
-        
-        // Update position based on velocity (assuming 10ms update rate)
-        motor.position += motor.actual_velocity * (10.0 / 60000.0) * 360.0; // degrees
+        if (accumulator > MAX_PHYSICS_LAG_MS) {
+            dropped_ms += static_cast<uint64_t>(accumulator - MAX_PHYSICS_LAG_MS);
+            accumulator = MAX_PHYSICS_LAG_MS;
+        }
         
-        // Simulate current draw
-        motor.current = static_cast<int32_t>(std::abs(motor.actual_velocity / max_velocity) * 2000);
+        double step_ms = _physics_step_ms;
+        while (accumulator >= step_ms && _physics_running) {
+            update();
+            accumulator -= step_ms;
+        }
         
-        // Simulate temperature
-        motor.temperature = 25.0 + (std::abs(motor.current) / 2500.0) * 30.0;
+        // Sleep until the next step is due
+        std::unique_lock<std::mutex> lock(_physics_mutex);
+        _physics_cv.wait_for(lock, std::chrono::duration<double, std::milli>(step_ms - accumulator),
+                             [this]() { return !_physics_running; });
     }
     
+    if (dropped_ms > 0) {
+        std::cerr << "Physics fell behind; skipped " << dropped_ms << " ms of simulated time" << std::endl;
+    }
+}
+
+void HAL::update() {
+    double step_ms = _physics_step_ms;
+    int substeps = _physics_substeps;
+    
+    // Simulate motor physics for every port, then publish once per step.
+    // Setters only wait for their own port's gather or scatter
+    {
+        std::lock_guard<std::mutex> lock(_lanes_mutex);
+        gather_motor_lanes();
+        for (int i = 0; i < substeps; i++) {
+            step_motors(_motor_lanes, step_ms / substeps);
+        }
+        scatter_motor_lanes();
+    }
+    
+    publish_snapshot();
+    
     // Notify callback if registered
+    std::lock_guard<std::mutex> lock(_callback_mutex);
     if (_state_callback) {
         _state_callback();
     }
@@ -95,206 +277,199 @@ void HAL::update() {
 // Motor functions
 void HAL::set_motor(uint8_t port, int32_t voltage) {
     if (port < 1 || port > 21) return;
-    std::lock_guard<std::mutex> lock(_mutex);
-    _motors[port - 1].voltage = std::clamp(voltage, -127, 127);
+    update_motor(port, [&](MotorState& motor) { motor.voltage = std::clamp(voltage, -127, 127); });
 }
 
 void HAL::set_motor_velocity(uint8_t port, int32_t velocity) {
     if (port < 1 || port > 21) return;
-    std::lock_guard<std::mutex> lock(_mutex);
-    _motors[port - 1].velocity = velocity;
+    update_motor(port, [&](MotorState& motor) { motor.velocity = velocity; });
 }
 
 void HAL::set_motor_position(uint8_t port, double position) {
     if (port < 1 || port > 21) return;
-    std::lock_guard<std::mutex> lock(_mutex);
-    _motors[port - 1].position = position;
+    MotorPort& motor = _motors[port - 1];
+    std::lock_guard<std::mutex> lock(motor.write_mutex);
+    motor.command.position = position;
+    motor.position_set = true;
+    motor.state.store(motor.command);
 }
 
 void HAL::set_motor_gearset(uint8_t port, pros::motor_gearset_e_t gearset) {
     if (port < 1 || port > 21) return;
-    std::lock_guard<std::mutex> lock(_mutex);
-    _motors[port - 1].gearset = gearset;
+    MotorPort& motor = _motors[port - 1];
+    std::lock_guard<std::mutex> lock(motor.write_mutex);
+    motor.command.gearset = gearset;
+    motor.refresh_limits();
+    motor.state.store(motor.command);
 }
 
 void HAL::set_motor_reversed(uint8_t port, bool reversed) {
     if (port < 1 || port > 21) return;
-    std::lock_guard<std::mutex> lock(_mutex);
-    _motors[port - 1].reversed = reversed;
+    update_motor(port, [&](MotorState& motor) { motor.reversed = reversed; });
 }
 
 void HAL::set_motor_connected(uint8_t port, bool connected) {
     if (port < 1 || port > 21) return;
-    std::lock_guard<std::mutex> lock(_mutex);
-    _motors[port - 1].connected = connected;
+    MotorPort& motor = _motors[port - 1];
+    std::lock_guard<std::mutex> lock(motor.write_mutex);
+    motor.command.connected = connected;
+    motor.refresh_limits();
+    motor.state.store(motor.command);
 }
 
 int32_t HAL::get_motor_voltage(uint8_t port) {
     if (port < 1 || port > 21) return 0;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _motors[port - 1].voltage;
+    return _motors[port - 1].state.load().voltage;
 }
 
 int32_t HAL::get_motor_velocity(uint8_t port) {
     if (port < 1 || port > 21) return 0;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _motors[port - 1].velocity;
+    return _motors[port - 1].state.load().velocity;
 }
 
 double HAL::get_motor_position(uint8_t port) {
     if (port < 1 || port > 21) return 0.0;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _motors[port - 1].position;
+    return _motors[port - 1].state.load().position;
 }
 
 double HAL::get_motor_actual_velocity(uint8_t port) {
     if (port < 1 || port > 21) return 0.0;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _motors[port - 1].actual_velocity;
+    return _motors[port - 1].state.load().actual_velocity;
 }
 
 int32_t HAL::get_motor_current(uint8_t port) {
     if (port < 1 || port > 21) return 0;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _motors[port - 1].current;
+    return _motors[port - 1].state.load().current;
 }
 
 double HAL::get_motor_temperature(uint8_t port) {
     if (port < 1 || port > 21) return 0.0;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _motors[port - 1].temperature;
+    return _motors[port - 1].state.load().temperature;
 }
 
 pros::motor_gearset_e_t HAL::get_motor_gearset(uint8_t port) {
     if (port < 1 || port > 21) return pros::E_MOTOR_GEARSET_INVALID;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _motors[port - 1].gearset;
+    return _motors[port - 1].state.load().gearset;
 }
 
 bool HAL::get_motor_reversed(uint8_t port) {
     if (port < 1 || port > 21) return false;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _motors[port - 1].reversed;
+    return _motors[port - 1].state.load().reversed;
 }
 
 bool HAL::is_motor_connected(uint8_t port) {
     if (port < 1 || port > 21) return false;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _motors[port - 1].connected;
+    return _motors[port - 1].state.load().connected;
 }
 
 // Controller functions
 void HAL::set_controller_analog(pros::controller_id_e_t id, pros::controller_analog_e_t channel, int32_t value) {
     if (id > 1 || channel > 3) return;
-    std::lock_guard<std::mutex> lock(_mutex);
-    _controllers[id].analog[channel] = std::clamp(value, -127, 127);
+    update_controller(id, [&](ControllerState& controller) {
+        controller.analog[channel] = std::clamp(value, -127, 127);
+    });
 }
 
 void HAL::set_controller_digital(pros::controller_id_e_t id, pros::controller_digital_e_t button, bool value) {
     if (id > 1 || button >= 18) return;
-    std::lock_guard<std::mutex> lock(_mutex);
-    _controllers[id].digital[button] = value;
+    update_controller(id, [&](ControllerState& controller) { controller.digital[button] = value; });
 }
 
 void HAL::set_controller_connected(pros::controller_id_e_t id, bool connected) {
     if (id > 1) return;
-    std::lock_guard<std::mutex> lock(_mutex);
-    _controllers[id].connected = connected;
+    update_controller(id, [&](ControllerState& controller) { controller.connected = connected; });
+}
+
+void HAL::set_controller_inputs(pros::controller_id_e_t id, const std::array<int32_t, 4>& analog,
+                                const std::array<bool, 18>& digital) {
+    if (id > 1) return;
+    update_controller(id, [&](ControllerState& controller) {
+        for (size_t i = 0; i < analog.size(); i++) {
+            controller.analog[i] = std::clamp(analog[i], -127, 127);
+        }
+        controller.digital = digital;
+    });
 }
 
 int32_t HAL::get_controller_analog(pros::controller_id_e_t id, pros::controller_analog_e_t channel) {
     if (id > 1 || channel > 3) return 0;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _controllers[id].analog[channel];
+    return _controllers[id].state.load().analog[channel];
 }
 
 bool HAL::get_controller_digital(pros::controller_id_e_t id, pros::controller_digital_e_t button) {
     if (id > 1 || button >= 18) return false;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _controllers[id].digital[button];
+    return _controllers[id].state.load().digital[button];
 }
 
 bool HAL::is_controller_connected(pros::controller_id_e_t id) {
     if (id > 1) return false;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _controllers[id].connected;
+    return _controllers[id].state.load().connected;
 }
 
 int32_t HAL::get_controller_battery_capacity(pros::controller_id_e_t id) {
     if (id > 1) return 0;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _controllers[id].battery_capacity;
+    return _controllers[id].state.load().battery_capacity;
 }
 
 int32_t HAL::get_controller_battery_level(pros::controller_id_e_t id) {
     if (id > 1) return 0;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _controllers[id].battery_level;
+    return _controllers[id].state.load().battery_level;
 }
 
 // Battery functions
 double HAL::get_battery_capacity() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _battery.capacity;
+    return _battery.load().capacity;
 }
 
 int32_t HAL::get_battery_current() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _battery.current;
+    return _battery.load().current;
 }
 
 double HAL::get_battery_temperature() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _battery.temperature;
+    return _battery.load().temperature;
 }
 
 int32_t HAL::get_battery_voltage() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _battery.voltage;
+    return _battery.load().voltage;
 }
 
 // Competition functions
 void HAL::set_robot_mode(RobotMode mode) {
-    std::lock_guard<std::mutex> lock(_mutex);
     _robot_mode = mode;
 }
 
 RobotMode HAL::get_robot_mode() {
-    std::lock_guard<std::mutex> lock(_mutex);
     return _robot_mode;
 }
 
 bool HAL::is_autonomous() {
-    std::lock_guard<std::mutex> lock(_mutex);
     return _robot_mode == RobotMode::AUTONOMOUS;
 }
 
 bool HAL::is_disabled() {
-    std::lock_guard<std::mutex> lock(_mutex);
     return _robot_mode == RobotMode::DISABLED;
 }
 
 bool HAL::is_connected() {
-    std::lock_guard<std::mutex> lock(_mutex);
     return _competition_connected;
 }
 
 // LCD functions
 void HAL::lcd_set_text(int16_t line, const std::string& text) {
     if (line < 0 || line > 7) return;
-    std::lock_guard<std::mutex> lock(_mutex);
+    std::lock_guard<std::mutex> lock(_lcd_mutex);
     _lcd_lines[line] = text;
     _lcd_initialized = true;
 }
 
 std::string HAL::lcd_get_text(int16_t line) {
     if (line < 0 || line > 7) return "";
-    std::lock_guard<std::mutex> lock(_mutex);
+    std::lock_guard<std::mutex> lock(_lcd_mutex);
     return _lcd_lines[line];
 }
 
 void HAL::lcd_clear() {
-    std::lock_guard<std::mutex> lock(_mutex);
+    std::lock_guard<std::mutex> lock(_lcd_mutex);
     for (auto& line : _lcd_lines) {
         line.clear();
     }
@@ -302,66 +477,45 @@ void HAL::lcd_clear() {
 
 void HAL::lcd_clear_line(int16_t line) {
     if (line < 0 || line > 7) return;
-    std::lock_guard<std::mutex> lock(_mutex);
+    std::lock_guard<std::mutex> lock(_lcd_mutex);
     _lcd_lines[line].clear();
 }
 
 void HAL::lcd_set_button(uint8_t button, bool pressed) {
-    std::lock_guard<std::mutex> lock(_mutex);
     if (pressed) {
-        _lcd_buttons |= button;
+        _lcd_buttons.fetch_or(button);
     } else {
-        _lcd_buttons &= ~button;
+        _lcd_buttons.fetch_and(static_cast<uint8_t>(~button));
     }
 }
 
 uint8_t HAL::lcd_get_buttons() {
-    std::lock_guard<std::mutex> lock(_mutex);
     return _lcd_buttons;
 }
 
 void HAL::lcd_set_background_color(uint32_t color) {
-    std::lock_guard<std::mutex> lock(_mutex);
     _lcd_bg_color = color;
 }
 
 void HAL::lcd_set_text_color(uint32_t color) {
-    std::lock_guard<std::mutex> lock(_mutex);
     _lcd_text_color = color;
 }
 
 uint32_t HAL::lcd_get_background_color() {
-    std::lock_guard<std::mutex> lock(_mutex);
     return _lcd_bg_color;
 }
 
 uint32_t HAL::lcd_get_text_color() {
-    std::lock_guard<std::mutex> lock(_mutex);
     return _lcd_text_color;
 }
 
 // State access for IPC
-const MotorState& HAL::get_motor_state(uint8_t port) {
-    static MotorState dummy;
-    if (port < 1 || port > 21) return dummy;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _motors[port - 1];
-}
-
-const ControllerState& HAL::get_controller_state(pros::controller_id_e_t id) {
-    static ControllerState dummy;
-    if (id > 1) return dummy;
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _controllers[id];
-}
-
-const BatteryState& HAL::get_battery_state() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _battery;
+void HAL::get_snapshot(HALSnapshot& out) {
+    _snapshot.load(out);
 }
 
 void HAL::set_state_callback(StateCallback callback) {
-    std::lock_guard<std::mutex> lock(_mutex);
+    std::lock_guard<std::mutex> lock(_callback_mutex);
     _state_callback = callback;
 }
 
@@ -5,10 +5,16 @@
 
 #include "host/ipc.hpp"
 #include "host/hal.hpp"
+#include "host/json_writer.hpp"
+#include <cassert>
+#include <cerrno>
 #include <cstring>
-#include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
 
 // Platform-specific includes
 #ifdef _WIN32
@@ -28,45 +34,56 @@
     #define closesocket close
 #endif
 
-// Simple Base64 encoding
-static const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+// Avoid SIGPIPE when the server goes away mid-write. Where send() has no
+// such flag (macOS), the socket gets SO_NOSIGPIPE instead
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
 
-static std::string base64_encode(const uint8_t* data, size_t len) {
-    std::string result;
-    result.reserve((len + 2) / 3 * 4);
-    
-    for (size_t i = 0; i < len; i += 3) {
-        uint32_t n = static_cast<uint32_t>(data[i]) << 16;
-        if (i + 1 < len) n |= static_cast<uint32_t>(data[i + 1]) << 8;
-        if (i + 2 < len) n |= static_cast<uint32_t>(data[i + 2]);
-        
-        result += base64_chars[(n >> 18) & 0x3F];
-        result += base64_chars[(n >> 12) & 0x3F];
-        result += (i + 1 < len) ? base64_chars[(n >> 6) & 0x3F] : '=';
-        result += (i + 2 < len) ? base64_chars[n & 0x3F] : '=';
-    }
-    
-    return result;
-}
-
-// Simple JSON helpers
-static std::string json_escape(const std::string& s) {
-    std::string result;
-    for (char c : s) {
-        switch (c) {
-            case '"': result += "\\\""; break;
-            case '\\': result += "\\\\"; break;
-            case '\n': result += "\\n"; break;
-            case '\r': result += "\\r"; break;
-            case '\t': result += "\\t"; break;
-            default: result += c; break;
-        }
-    }
-    return result;
-}
+// Outbound queue capacity (messages)
+static constexpr size_t RELIABLE_QUEUE_CAPACITY = 256;
+
+// Give up on a server that does not answer the upgrade request
+static constexpr int HANDSHAKE_TIMEOUT_MS = 5000;
+
+// A server that takes nothing for this long is gone; the writer gives up on it
+// rather than blocking shutdown in send()
+static constexpr int SEND_TIMEOUT_MS = 5000;
+static constexpr size_t MAX_HANDSHAKE_RESPONSE = 8192;
+
+// Message buffers kept for reuse. Screen frames get a few buffers of their
+// own, large enough for a keyframe, so they do not pin memory in the main pool
+static constexpr size_t BUFFER_POOL_CAPACITY = 128;
+static constexpr size_t MAX_POOLED_BUFFER = 4096;
+static constexpr size_t SCREEN_POOL_CAPACITY = 4;
+static constexpr size_t MAX_POOLED_SCREEN_BUFFER = 512 * 1024;
+
+// Ranges of inbound numbers: joystick axes, the V5 screen (480x272), the
+// 32-bit button mask and the auton list index
+static constexpr double MAX_AXIS = 127.0;
+static constexpr double MAX_TOUCH_X = 479.0;
+static constexpr double MAX_TOUCH_Y = 271.0;
+static constexpr double MAX_BUTTONS = static_cast<double>(std::numeric_limits<uint32_t>::max());
+static constexpr double MAX_INDEX = static_cast<double>(std::numeric_limits<int>::max());
+
+// Default flush interval for coalesced telemetry (50 Hz)
+static constexpr uint32_t DEFAULT_FLUSH_INTERVAL_MS = 20;
 
 namespace host {
 
+// Sets (or with 0, clears) a socket timeout (SO_RCVTIMEO or SO_SNDTIMEO)
+static void set_socket_timeout(int fd, int option, int timeout_ms) {
+#ifdef _WIN32
+    DWORD timeout = static_cast<DWORD>(timeout_ms);
+    setsockopt(fd, SOL_SOCKET, option, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#else
+    struct timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, option, &timeout, sizeof(timeout));
+#endif
+}
+
 // Singleton instance
 IPCClient& IPCClient::instance() {
     static IPCClient instance;
@@ -74,7 +91,13 @@ IPCClient& IPCClient::instance() {
 }
 
 IPCClient::IPCClient() 
-    : _connected(false), _running(false), _socket_fd(INVALID_SOCKET) {
+    : _connected(false), _running(false), _socket_fd(INVALID_SOCKET),
+      _reliable_queue(RELIABLE_QUEUE_CAPACITY), _writer_waiting(false), _space_waiters(0), _close_code(0),
+      _latest_pending(false), _dropped(0), _screen_dropped(false),
+      _buffer_pool(BUFFER_POOL_CAPACITY), _screen_pool(SCREEN_POOL_CAPACITY),
+      _slots_pending(false), _flush_interval_ms(DEFAULT_FLUSH_INTERVAL_MS), _screen_seq(0) {
+    std::random_device rd;
+    _mask_state = (static_cast<uint64_t>(rd()) << 32) | rd() | 1;
 #ifdef _WIN32
     WSADATA wsaData;
     WSAStartup(MAKEWORD(2, 2), &wsaData);
@@ -98,6 +121,11 @@ bool IPCClient::connect(const std::string& host, uint16_t port) {
         return false;
     }
     
+#ifdef SO_NOSIGPIPE
+    int no_sigpipe = 1;
+    setsockopt(_socket_fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+    
     // Resolve hostname
     struct hostent* he = gethostbyname(host.c_str());
     if (!he) {
@@ -121,23 +149,97 @@ bool IPCClient::connect(const std::string& host, uint16_t port) {
         return false;
     }
     
+    if (!handshake(host, port)) {
+        std::cerr << "WebSocket handshake with " << host << ":" << port << " failed" << std::endl;
+        closesocket(_socket_fd);
+        _socket_fd = INVALID_SOCKET;
+        return false;
+    }
+    
+    set_socket_timeout(_socket_fd, SO_SNDTIMEO, SEND_TIMEOUT_MS);
+    
+    // A screen message left over from an earlier connection is stale
+    {
+        std::lock_guard<std::mutex> lock(_latest_mutex);
+        _latest = OutboundMessage();
+        _latest_pending = false;
+    }
+    _close_code = 0;
+    
     _connected = true;
     _running = true;
     
-    // Start receive thread
+    // Start receive and writer threads
     _receive_thread = std::thread(&IPCClient::receive_thread, this);
+    _writer_thread = std::thread(&IPCClient::writer_thread, this);
     
     std::cout << "Connected to WebSocket server at " << host << ":" << port << std::endl;
     return true;
 }
 
+bool IPCClient::handshake(const std::string& host, uint16_t port) {
+    std::string key;
+    std::string request = websocket_handshake_request(host, port, "/host", key);
+    
+    size_t sent = 0;
+    while (sent < request.size()) {
+        int bytes = send(_socket_fd, request.data() + sent, static_cast<int>(request.size() - sent), MSG_NOSIGNAL);
+        if (bytes <= 0) return false;
+        sent += static_cast<size_t>(bytes);
+    }
+    
+    // Read up to the blank line that ends the response headers
+    set_socket_timeout(_socket_fd, SO_RCVTIMEO, HANDSHAKE_TIMEOUT_MS);
+    std::string response;
+    size_t header_end = std::string::npos;
+    char buffer[1024];
+    while (header_end == std::string::npos) {
+        if (response.size() > MAX_HANDSHAKE_RESPONSE) return false;
+        int bytes = recv(_socket_fd, buffer, sizeof(buffer), 0);
+        if (bytes <= 0) return false;
+        response.append(buffer, static_cast<size_t>(bytes));
+        header_end = response.find("\r\n\r\n");
+    }
+    set_socket_timeout(_socket_fd, SO_RCVTIMEO, 0);
+    
+    if (!websocket_handshake_valid(response.substr(0, header_end + 4), key)) return false;
+    
+    // The server may start sending frames right behind its response
+    _parser.reset();
+    size_t extra = response.size() - (header_end + 4);
+    if (extra > 0) {
+        _parser.feed(reinterpret_cast<const uint8_t*>(response.data() + header_end + 4), extra);
+    }
+    return true;
+}
+
 void IPCClient::disconnect() {
-    if (!_connected) return;
+    if (!_running) return;
     
+    // Closing handshake; the writer sends it before it exits. It is a flag,
+    // not a queued message, so a full queue cannot block shutdown
+    _close_code = WS_CLOSE_NORMAL;
     _running = false;
     _connected = false;
     
+    // Let the writer flush what is already queued before the socket goes away,
+    // and release producers still waiting for queue space
+    {
+        std::lock_guard<std::mutex> lock(_writer_mutex);
+        _writer_cv.notify_one();
+        _space_cv.notify_all();
+    }
+    if (_writer_thread.joinable()) {
+        _writer_thread.join();
+    }
+    
+    // Shut down first so a receive thread blocked in recv() wakes up
     if (_socket_fd != INVALID_SOCKET) {
+#ifdef _WIN32
+        shutdown(_socket_fd, SD_BOTH);
+#else
+        shutdown(_socket_fd, SHUT_RDWR);
+#endif
         closesocket(_socket_fd);
         _socket_fd = INVALID_SOCKET;
     }
@@ -152,10 +254,14 @@ bool IPCClient::is_connected() {
 }
 
 void IPCClient::receive_thread() {
-    char buffer[4096];
-    
     while (_running && _connected) {
-        int bytes = recv(_socket_fd, buffer, sizeof(buffer) - 1, 0);
+        // Handle complete frames first (the handshake may have left some behind)
+        if (!process_frames()) break;
+        
+        // Receive straight into the parser's ring buffer
+        size_t available;
+        uint8_t* buffer = _parser.write_ptr(available);
+        int bytes = recv(_socket_fd, reinterpret_cast<char*>(buffer), static_cast<int>(available), 0);
         if (bytes <= 0) {
             if (_running) {
                 std::cerr << "Connection lost" << std::endl;
@@ -163,105 +269,529 @@ void IPCClient::receive_thread() {
             }
             break;
         }
+        _parser.commit(static_cast<size_t>(bytes));
+    }
+}
+
+bool IPCClient::process_frames() {
+    while (true) {
+        switch (_parser.next()) {
+            case WebSocketParser::Result::NEED_MORE:
+                return true;
+            
+            case WebSocketParser::Result::MESSAGE:
+                // The server only sends JSON text to the host
+                if (_parser.message_opcode() == WS_OPCODE_TEXT) {
+                    parse_message(_parser.message());
+                }
+                break;
+            
+            case WebSocketParser::Result::PING: {
+                OutboundMessage pong;
+                pong.opcode = WS_OPCODE_PONG;
+                pong.payload = acquire_buffer();
+                pong.payload += _parser.control_payload();
+                enqueue(std::move(pong), SendPolicy::RELIABLE);
+                break;
+            }
+            
+            case WebSocketParser::Result::PONG:
+                break;
+            
+            case WebSocketParser::Result::CLOSE:
+                // Echo the status code to complete the closing handshake
+                std::cerr << "Server closed connection (" << _parser.close_code() << ")" << std::endl;
+                send_close(_parser.close_code() == 1005 ? WS_CLOSE_NORMAL : _parser.close_code());
+                _connected = false;
+                return false;
+            
+            case WebSocketParser::Result::PROTOCOL_ERROR:
+                std::cerr << "WebSocket protocol error, closing connection" << std::endl;
+                send_close(_parser.error_code());
+                _connected = false;
+                return false;
+        }
+    }
+}
+
+std::string IPCClient::acquire_buffer() {
+    std::string buffer;
+    _buffer_pool.try_pop(buffer);
+    buffer.assign(WS_MAX_CLIENT_HEADER, '\0');
+    return buffer;
+}
+
+std::string IPCClient::acquire_screen_buffer(size_t size) {
+    std::string buffer;
+    _screen_pool.try_pop(buffer);
+    buffer.reserve(size);
+    buffer.assign(WS_MAX_CLIENT_HEADER, '\0');
+    return buffer;
+}
+
+void IPCClient::release_buffer(std::string&& buffer) {
+    if (buffer.capacity() <= MAX_POOLED_BUFFER) {
+        _buffer_pool.try_push(buffer);
+    } else if (buffer.capacity() <= MAX_POOLED_SCREEN_BUFFER) {
+        _screen_pool.try_push(buffer);
+    }
+}
+
+void IPCClient::send_message(std::string json, SendPolicy policy) {
+    OutboundMessage message;
+    message.opcode = WS_OPCODE_TEXT;
+    message.payload = std::move(json);
+    enqueue(std::move(message), policy);
+}
+
+void IPCClient::send_close(uint16_t code) {
+    // Never blocks: the writer sends the close frame once the queue drains
+    _close_code = code;
+    wake_writer();
+}
+
+void IPCClient::enqueue(OutboundMessage&& message, SendPolicy policy) {
+    if (!_connected) return;
+    
+    if (policy == SendPolicy::LATEST) {
+        std::string replaced;
+        {
+            std::lock_guard<std::mutex> lock(_latest_mutex);
+            if (_latest_pending) {
+                // A keyframe covers whatever it replaces. Anything else leaves
+                // the UI a delta short, so the display has to send a keyframe
+                _dropped++;
+                if (!message.keyframe) _screen_dropped = true;
+                replaced = std::move(_latest.payload);
+            }
+            _latest = std::move(message);
+            _latest_pending = true;
+        }
+        if (!replaced.empty()) release_buffer(std::move(replaced));
+    } else if (!_reliable_queue.try_push(message)) {
+        // Never drop: sleep until the writer makes room
+        std::unique_lock<std::mutex> lock(_writer_mutex);
+        _space_waiters++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool pushed = false;
+        _space_cv.wait(lock, [&]() {
+            pushed = _reliable_queue.try_push(message);
+            return pushed || !_connected;
+        });
+        _space_waiters--;
+        if (!pushed) return;
+    }
+    
+    wake_writer();
+}
+
+void IPCClient::wake_writer() {
+    // Pairs with the fence in writer_thread(): either the writer sees the new
+    // message before it sleeps or this sees it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_writer_waiting.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(_writer_mutex);
+        _writer_cv.notify_one();
+    }
+}
+
+bool IPCClient::take_latest(OutboundMessage& message) {
+    if (!_latest_pending) return false;
+    std::lock_guard<std::mutex> lock(_latest_mutex);
+    if (!_latest_pending) return false;
+    message = std::move(_latest);
+    _latest = OutboundMessage();
+    _latest_pending = false;
+    return true;
+}
+
+void IPCClient::writer_thread() {
+    OutboundMessage message;
+    auto next_flush = std::chrono::steady_clock::now();
+    
+    while (true) {
+        // Coalesced telemetry goes out at a fixed rate. Checked before the
+        // queues so continuous screen traffic cannot starve it
+        auto now = std::chrono::steady_clock::now();
+        if (_slots_pending && now >= next_flush) {
+            if (!flush_slots()) {
+                if (_running) {
+                    std::cerr << "Connection lost" << std::endl;
+                    _connected = false;
+                }
+                break;
+            }
+            next_flush = now + std::chrono::milliseconds(_flush_interval_ms.load());
+            continue;
+        }
         
-        buffer[bytes] = '\0';
-        parse_message(buffer);
+        // Control messages go first so they never sit behind screen data
+        bool reliable = _reliable_queue.try_pop(message);
+        if (reliable || take_latest(message)) {
+            if (reliable) {
+                // Wake producers blocked on a full queue (pairs with enqueue())
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (_space_waiters.load(std::memory_order_relaxed) > 0) {
+                    std::lock_guard<std::mutex> lock(_writer_mutex);
+                    _space_cv.notify_all();
+                }
+            }
+            if (!write_frame(message)) {
+                if (_running) {
+                    std::cerr << "Connection lost" << std::endl;
+                    _connected = false;
+                }
+                break;
+            }
+            release_buffer(std::move(message.payload));
+            continue;
+        }
+        
+        // Read before the close code: disconnect() sets the code first, so a
+        // stopped writer always sees it
+        bool stopping = !_running;
+        uint16_t close_code = _close_code.exchange(0);
+        if (close_code != 0) {
+            // Nothing may follow a close frame
+            message.opcode = WS_OPCODE_CLOSE;
+            message.payload = acquire_buffer();
+            message.payload.push_back(static_cast<char>(close_code >> 8));
+            message.payload.push_back(static_cast<char>(close_code & 0xFF));
+            write_frame(message);
+            break;
+        }
+        if (stopping) break;
+        
+        // Nothing to do yet: sleep until a producer wakes us or the next flush
+        std::unique_lock<std::mutex> lock(_writer_mutex);
+        _writer_waiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto ready = [this]() {
+            return !_reliable_queue.empty() || _latest_pending || _close_code != 0 || !_running;
+        };
+        if (_slots_pending) {
+            _writer_cv.wait_until(lock, next_flush, ready);
+        } else {
+            _writer_cv.wait(lock, [&]() { return ready() || _slots_pending; });
+        }
+        _writer_waiting = false;
     }
+    
+    // Nothing drains the queue any more: let blocked producers give up
+    std::lock_guard<std::mutex> lock(_writer_mutex);
+    _space_cv.notify_all();
 }
 
-void IPCClient::send_message(const std::string& json) {
+void IPCClient::send_latest(IPCMessageType type, uint32_t key, std::string json) {
     if (!_connected) return;
     
-    std::lock_guard<std::mutex> lock(_send_mutex);
+    {
+        std::lock_guard<std::mutex> lock(_slot_mutex);
+        Slot& slot = _slots[(static_cast<uint32_t>(type) << 16) | key];
+        if (slot.dirty || json != slot.last_sent) {
+            // Keep the newest value; the buffer it replaces goes back to the pool
+            slot.pending.swap(json);
+            slot.dirty = true;
+        }
+    }
+    release_buffer(std::move(json));
     
-    // Simple WebSocket frame (text, no mask for server->client)
-    std::string frame;
-    frame += static_cast<char>(0x81); // Text frame, FIN bit set
+    if (!_slots_pending.exchange(true)) wake_writer();
+}
+
+bool IPCClient::flush_slots() {
+    size_t count = 0;
     
-    if (json.size() <= 125) {
-        frame += static_cast<char>(json.size());
-    } else if (json.size() <= 65535) {
-        frame += static_cast<char>(126);
-        frame += static_cast<char>((json.size() >> 8) & 0xFF);
-        frame += static_cast<char>(json.size() & 0xFF);
+    {
+        std::lock_guard<std::mutex> lock(_slot_mutex);
+        _slots_pending = false;
+        for (auto& entry : _slots) {
+            Slot& slot = entry.second;
+            if (!slot.dirty) continue;
+            if (count == _flush_batch.size()) _flush_batch.emplace_back();
+            _flush_batch[count].opcode = WS_OPCODE_TEXT;
+            _flush_batch[count].payload = slot.pending;
+            slot.last_sent.swap(slot.pending);
+            slot.dirty = false;
+            count++;
+        }
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        if (!write_frame(_flush_batch[i])) return false;
+    }
+    return true;
+}
+
+void IPCClient::invalidate_slots() {
+    std::lock_guard<std::mutex> lock(_slot_mutex);
+    for (auto& entry : _slots) {
+        entry.second.last_sent.clear();
+    }
+}
+
+bool IPCClient::write_frame(OutboundMessage& message) {
+    // Every payload starts with the header space acquire_buffer() reserves;
+    // one without it was built wrong and cannot be framed
+    if (message.payload.size() < WS_MAX_CLIENT_HEADER) {
+        std::cerr << "Outbound message without header space (" << message.payload.size() << " bytes)" << std::endl;
+        assert(false && "payload must start with WS_MAX_CLIENT_HEADER reserved bytes");
+        return false;
+    }
+    
+    // Client frames must be masked (RFC 6455 section 5.3)
+    uint8_t header[WS_MAX_CLIENT_HEADER];
+    size_t header_len = 0;
+    size_t len = message.payload.size() - WS_MAX_CLIENT_HEADER;
+    
+    header[header_len++] = static_cast<uint8_t>(0x80 | message.opcode); // FIN bit set
+    if (len <= 125) {
+        header[header_len++] = static_cast<uint8_t>(0x80 | len);
+    } else if (len <= 65535) {
+        header[header_len++] = 0x80 | 126;
+        header[header_len++] = static_cast<uint8_t>((len >> 8) & 0xFF);
+        header[header_len++] = static_cast<uint8_t>(len & 0xFF);
     } else {
-        // Extended length - not typically needed
-        frame += static_cast<char>(127);
+        header[header_len++] = 0x80 | 127;
         for (int i = 7; i >= 0; i--) {
-            frame += static_cast<char>((json.size() >> (i * 8)) & 0xFF);
+            header[header_len++] = static_cast<uint8_t>((static_cast<uint64_t>(len) >> (i * 8)) & 0xFF);
         }
     }
     
-    frame += json;
+    // Fresh masking key per frame (xorshift64)
+    _mask_state ^= _mask_state << 13;
+    _mask_state ^= _mask_state >> 7;
+    _mask_state ^= _mask_state << 17;
+    uint8_t* key = header + header_len;
+    for (int i = 0; i < 4; i++) {
+        key[i] = static_cast<uint8_t>(_mask_state >> (i * 8));
+    }
+    header_len += 4;
+    
+    // The payload is not needed after this write, so mask it in place
+    uint8_t* payload = reinterpret_cast<uint8_t*>(&message.payload[WS_MAX_CLIENT_HEADER]);
+    websocket_mask(payload, len, key);
+    
+    // Header goes into the reserved space so the frame is one contiguous write
+    uint8_t* frame = payload - header_len;
+    memcpy(frame, header, header_len);
+    size_t remaining = header_len + len;
     
-    send(_socket_fd, frame.c_str(), frame.size(), 0);
+    while (remaining > 0) {
+        int sent = send(_socket_fd, reinterpret_cast<const char*>(frame),
+                        static_cast<int>(std::min<size_t>(remaining, 1 << 30)), MSG_NOSIGNAL);
+        if (sent < 0) {
+#ifndef _WIN32
+            if (errno == EINTR) continue;
+#endif
+            return false;
+        }
+        frame += sent;
+        remaining -= static_cast<size_t>(sent);
+    }
+    
+    return true;
 }
 
-void IPCClient::parse_message(const std::string& json) {
-    // Very simple JSON parsing for expected message formats
-    // In production, use a proper JSON library
+/**
+ * Collects the fields of one inbound message from parser events
+ *
+ * Every known field is captured regardless of key order, then the message is
+ * dispatched on its type once parsing is complete.
+ */
+class InboundMessage : public JsonHandler {
+public:
+    enum class Type { UNKNOWN, TOUCH, CONTROLLER, MODE, SELECT_AUTO, KEYFRAME };
     
-    std::lock_guard<std::mutex> lock(_callback_mutex);
+    Type type = Type::UNKNOWN;
+    TouchInput touch = {0, 0, false};
+    ControllerInput controller = {0, 0, 0, 0, 0};
+    char value[32] = {};       // mode
+    char category[32] = {};    // select_auto
+    int index = -1;            // select_auto
     
-    if (json.find("\"type\":\"touch\"") != std::string::npos) {
-        if (_touch_callback) {
-            TouchInput input;
-            // Parse x, y, pressed from JSON
-            size_t xpos = json.find("\"x\":");
-            size_t ypos = json.find("\"y\":");
-            size_t ppos = json.find("\"pressed\":");
-            
-            if (xpos != std::string::npos) input.x = std::stoi(json.substr(xpos + 4));
-            if (ypos != std::string::npos) input.y = std::stoi(json.substr(ypos + 4));
-            if (ppos != std::string::npos) input.pressed = (json.substr(ppos + 10, 4) == "true");
-            
-            _touch_callback(input);
-        }
+    void begin_object() override {
+        if (_depth == 1) _in_analog = (_key == "analog");
+        _depth++;
+        _key = std::string_view();
     }
-    else if (json.find("\"type\":\"controller\"") != std::string::npos) {
-        if (_controller_callback) {
-            ControllerInput input = {0, 0, 0, 0, 0};
-            // Parse analog and digital values
-            // ... simplified parsing
-            _controller_callback(input);
+    
+    void end_object() override {
+        _depth--;
+        if (_depth == 1) _in_analog = false;
+    }
+    
+    void key(std::string_view name) override {
+        // Protocol keys never contain escapes, so this views the message itself
+        _key = name;
+    }
+    
+    void string_value(std::string_view str) override {
+        if (_depth != 1) return;
+        if (_key == "type") {
+            if (str == "touch") type = Type::TOUCH;
+            else if (str == "controller") type = Type::CONTROLLER;
+            else if (str == "mode") type = Type::MODE;
+            else if (str == "select_auto") type = Type::SELECT_AUTO;
+            else if (str == "keyframe") type = Type::KEYFRAME;
+        } else if (_key == "value") {
+            copy(value, sizeof(value), str);
+        } else if (_key == "category") {
+            copy(category, sizeof(category), str);
         }
     }
-    else if (json.find("\"type\":\"mode\"") != std::string::npos) {
-        if (_mode_callback) {
-            size_t vpos = json.find("\"value\":\"");
-            if (vpos != std::string::npos) {
-                size_t start = vpos + 9;
-                size_t end = json.find("\"", start);
-                std::string mode = json.substr(start, end - start);
-                _mode_callback(mode);
-            }
+    
+    void number_value(double number) override {
+        // Clamped before every cast: an out-of-range double is undefined
+        // behavior when converted to an integer
+        if (!std::isfinite(number)) return;
+        if (_depth == 2 && _in_analog) {
+            int32_t axis = static_cast<int32_t>(std::clamp(number, -MAX_AXIS, MAX_AXIS));
+            if (_key == "lx") controller.lx = axis;
+            else if (_key == "ly") controller.ly = axis;
+            else if (_key == "rx") controller.rx = axis;
+            else if (_key == "ry") controller.ry = axis;
+            return;
         }
+        if (_depth != 1) return;
+        if (_key == "x") touch.x = static_cast<int16_t>(std::clamp(number, 0.0, MAX_TOUCH_X));
+        else if (_key == "y") touch.y = static_cast<int16_t>(std::clamp(number, 0.0, MAX_TOUCH_Y));
+        else if (_key == "digital") controller.buttons = static_cast<uint32_t>(std::clamp(number, 0.0, MAX_BUTTONS));
+        else if (_key == "index") index = static_cast<int>(std::clamp(number, -1.0, MAX_INDEX));  // -1: none
     }
-    else if (json.find("\"type\":\"select_auto\"") != std::string::npos) {
-        if (_auto_select_callback) {
-            size_t cpos = json.find("\"category\":\"");
-            size_t ipos = json.find("\"index\":");
-            
-            if (cpos != std::string::npos && ipos != std::string::npos) {
-                size_t cstart = cpos + 12;
-                size_t cend = json.find("\"", cstart);
-                std::string category = json.substr(cstart, cend - cstart);
-                int index = std::stoi(json.substr(ipos + 8));
-                _auto_select_callback(category, index);
+    
+    void bool_value(bool b) override {
+        if (_depth == 1 && _key == "pressed") touch.pressed = b;
+    }
+    
+private:
+    static void copy(char* dst, size_t size, std::string_view src) {
+        size_t len = std::min(src.size(), size - 1);
+        memcpy(dst, src.data(), len);
+        dst[len] = '\0';
+    }
+    
+    int _depth = 0;
+    bool _in_analog = false;
+    std::string_view _key;
+};
+
+void IPCClient::parse_message(std::string_view json) {
+    InboundMessage message;
+    if (!_json_reader.parse(json, message)) {
+        std::cerr << "Ignoring malformed message from server" << std::endl;
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(_callback_mutex);
+    
+    switch (message.type) {
+        case InboundMessage::Type::TOUCH:
+            if (_touch_callback) _touch_callback(message.touch);
+            break;
+        
+        case InboundMessage::Type::CONTROLLER:
+            if (_controller_callback) _controller_callback(message.controller);
+            break;
+        
+        case InboundMessage::Type::MODE:
+            if (_mode_callback && message.value[0] != '\0') _mode_callback(message.value);
+            break;
+        
+        case InboundMessage::Type::SELECT_AUTO:
+            if (_auto_select_callback && message.category[0] != '\0' && message.index >= 0) {
+                _auto_select_callback(message.category, message.index);
             }
+            break;
+        
+        case InboundMessage::Type::KEYFRAME:
+            // A new viewer connected: it also needs the current telemetry values
+            invalidate_slots();
+            if (_keyframe_callback) _keyframe_callback();
+            break;
+        
+        case InboundMessage::Type::UNKNOWN:
+            break;
+    }
+}
+
+// Little-endian field writers for binary frames
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+// Payload size of a screen record in bytes
+static size_t screen_payload_size(const ScreenUpdate& update) {
+    if (update.source) {
+        return static_cast<size_t>(update.x2 - update.x1 + 1) * (update.y2 - update.y1 + 1) * sizeof(uint16_t);
+    }
+    return update.pixels.size() * sizeof(uint16_t);
+}
+
+// Appends one screen record (header + payload) to a binary frame
+static void append_screen_record(std::string& frame, const ScreenUpdate& update, uint32_t seq) {
+    size_t payload_len = screen_payload_size(update);
+    size_t offset = frame.size();
+    frame.resize(offset + SCREEN_HEADER_SIZE + payload_len);
+    uint8_t* hdr = reinterpret_cast<uint8_t*>(&frame[offset]);
+    
+    hdr[0] = SCREEN_FRAME_MAGIC;
+    hdr[1] = static_cast<uint8_t>(update.encoding);
+    put_u16(hdr + 2, update.flags);
+    put_u32(hdr + 4, seq);
+    put_u16(hdr + 8, static_cast<uint16_t>(update.x1));
+    put_u16(hdr + 10, static_cast<uint16_t>(update.y1));
+    put_u16(hdr + 12, static_cast<uint16_t>(update.x2));
+    put_u16(hdr + 14, static_cast<uint16_t>(update.y2));
+    put_u32(hdr + 16, static_cast<uint32_t>(payload_len));
+    
+    // Payload words go out in host byte order (little-endian on all supported hosts)
+    if (payload_len == 0) return;
+    if (update.source) {
+        size_t row_bytes = static_cast<size_t>(update.x2 - update.x1 + 1) * sizeof(uint16_t);
+        uint8_t* dst = hdr + SCREEN_HEADER_SIZE;
+        for (int32_t y = 0; y <= update.y2 - update.y1; y++) {
+            memcpy(dst, update.source + y * update.source_stride, row_bytes);
+            dst += row_bytes;
         }
+    } else {
+        memcpy(hdr + SCREEN_HEADER_SIZE, update.pixels.data(), payload_len);
     }
 }
 
 void IPCClient::send_screen_update(const ScreenUpdate& update) {
-    std::ostringstream ss;
-    ss << "{\"type\":\"screen\",\"x1\":" << update.x1
-       << ",\"y1\":" << update.y1
-       << ",\"x2\":" << update.x2
-       << ",\"y2\":" << update.y2
-       << ",\"data\":\"" << base64_encode(reinterpret_cast<const uint8_t*>(update.pixels.data()),
-                                          update.pixels.size() * 2) << "\"}";
-    send_message(ss.str());
+    send_screen_batch(&update, 1);
+}
+
+void IPCClient::send_screen_batch(const std::vector<ScreenUpdate>& updates) {
+    send_screen_batch(updates.data(), updates.size());
+}
+
+void IPCClient::send_screen_batch(const ScreenUpdate* updates, size_t count) {
+    if (count == 0) return;
+    
+    size_t total = WS_MAX_CLIENT_HEADER;
+    for (size_t i = 0; i < count; i++) {
+        total += SCREEN_HEADER_SIZE + screen_payload_size(updates[i]);
+    }
+    
+    OutboundMessage message;
+    message.opcode = WS_OPCODE_BINARY;
+    message.payload = acquire_screen_buffer(total);
+    uint32_t seq = _screen_seq++;
+    for (size_t i = 0; i < count; i++) {
+        append_screen_record(message.payload, updates[i], seq);
+        if (updates[i].flags & SCREEN_FLAG_KEYFRAME) message.keyframe = true;
+    }
+    enqueue(std::move(message), SendPolicy::LATEST);
 }
 
 void IPCClient::send_full_screen(const uint16_t* pixels) {
@@ -274,54 +804,143 @@ void IPCClient::send_full_screen(const uint16_t* pixels) {
     send_screen_update(update);
 }
 
+void IPCClient::send_screen_notify(const std::string& name, uint64_t frame, bool keyframe) {
+    if (!_connected) return;
+    std::string buffer = acquire_buffer();
+    JsonWriter json(buffer);
+    json.begin_object()
+        .key("type").value("screen_shm")
+        .key("name").value(name)
+        .key("frame").value(frame)
+        .key("keyframe").value(keyframe)
+        .end_object();
+    
+    OutboundMessage message;
+    message.opcode = WS_OPCODE_TEXT;
+    message.keyframe = keyframe;
+    message.payload = std::move(buffer);
+    enqueue(std::move(message), SendPolicy::LATEST);
+}
+
 void IPCClient::send_motor_telemetry(uint8_t port, int32_t voltage, double velocity, double position) {
-    std::ostringstream ss;
-    ss << "{\"type\":\"motor\",\"port\":" << static_cast<int>(port)
-       << ",\"voltage\":" << voltage
-       << ",\"velocity\":" << velocity
-       << ",\"position\":" << position << "}";
-    send_message(ss.str());
+    if (!_connected) return;
+    std::string buffer = acquire_buffer();
+    JsonWriter json(buffer);
+    json.begin_object()
+        .key("type").value("motor")
+        .key("port").value(port)
+        .key("voltage").value(voltage)
+        .key("velocity").value(velocity)
+        .key("position").value(position)
+        .end_object();
+    send_latest(IPCMessageType::MOTOR, port, std::move(buffer));
 }
 
 void IPCClient::send_log(const std::string& level, const std::string& message) {
-    std::ostringstream ss;
-    ss << "{\"type\":\"log\",\"level\":\"" << json_escape(level)
-       << "\",\"msg\":\"" << json_escape(message) << "\"}";
-    send_message(ss.str());
+    if (!_connected) return;
+    std::string buffer = acquire_buffer();
+    JsonWriter json(buffer);
+    json.begin_object()
+        .key("type").value("log")
+        .key("level").value(level)
+        .key("msg").value(message)
+        .end_object();
+    send_message(std::move(buffer));
 }
 
 void IPCClient::send_auton_list(const std::vector<std::string>& match_autos,
                                  const std::vector<std::string>& skills_autos) {
-    std::ostringstream ss;
-    ss << "{\"type\":\"autons\",\"match\":[";
-    for (size_t i = 0; i < match_autos.size(); i++) {
-        if (i > 0) ss << ",";
-        ss << "{\"name\":\"" << json_escape(match_autos[i]) << "\"}";
+    if (!_connected) return;
+    std::string buffer = acquire_buffer();
+    JsonWriter json(buffer);
+    json.begin_object().key("type").value("autons");
+    json.key("match").begin_array();
+    for (const auto& name : match_autos) {
+        json.begin_object().key("name").value(name).end_object();
     }
-    ss << "],\"skills\":[";
-    for (size_t i = 0; i < skills_autos.size(); i++) {
-        if (i > 0) ss << ",";
-        ss << "{\"name\":\"" << json_escape(skills_autos[i]) << "\"}";
+    json.end_array();
+    json.key("skills").begin_array();
+    for (const auto& name : skills_autos) {
+        json.begin_object().key("name").value(name).end_object();
     }
-    ss << "]}";
-    send_message(ss.str());
+    json.end_array();
+    json.end_object();
+    send_message(std::move(buffer));
 }
 
 void IPCClient::send_lcd_update(const std::vector<std::string>& lines) {
-    std::ostringstream ss;
-    ss << "{\"type\":\"lcd\",\"lines\":[";
-    for (size_t i = 0; i < lines.size(); i++) {
-        if (i > 0) ss << ",";
-        ss << "\"" << json_escape(lines[i]) << "\"";
+    if (!_connected) return;
+    std::string buffer = acquire_buffer();
+    JsonWriter json(buffer);
+    json.begin_object().key("type").value("lcd").key("lines").begin_array();
+    for (const auto& line : lines) {
+        json.value(line);
+    }
+    json.end_array().end_object();
+    send_latest(IPCMessageType::LCD, 0, std::move(buffer));
+}
+
+void IPCClient::send_task_stats(uint32_t time_ms, const std::vector<TaskStats>& tasks) {
+    if (!_connected) return;
+    std::string buffer = acquire_buffer();
+    JsonWriter json(buffer);
+    json.begin_object()
+        .key("type").value("tasks")
+        .key("time_ms").value(time_ms)
+        .key("wall_us").value(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count()))
+        .key("bounds_us").begin_array();
+    for (uint32_t bound : LATENESS_BOUNDS_US) {
+        json.value(bound);
+    }
+    json.end_array().key("tasks").begin_array();
+    for (const auto& task : tasks) {
+        const TaskTiming& timing = task.timing;
+        json.begin_object()
+            .key("id").value(task.id)
+            .key("name").value(task.name)
+            .key("priority").value(task.priority)
+            .key("cpu_us").value(timing.cpu_us)
+            .key("wakeups").value(timing.wakeups)
+            .key("late_total_us").value(timing.lateness_total_us)
+            .key("late_max_us").value(timing.lateness_max_us)
+            .key("periods").value(timing.periods)
+            .key("overruns").value(timing.overruns)
+            .key("jitter_total_us").value(timing.jitter_total_us)
+            .key("jitter_max_us").value(timing.jitter_max_us)
+            .key("period_us").value(timing.last_period_us)
+            .key("lateness").begin_array();
+        for (uint32_t count : timing.lateness) {
+            json.value(count);
+        }
+        json.end_array().end_object();
     }
-    ss << "]}";
-    send_message(ss.str());
+    json.end_array().end_object();
+    send_latest(IPCMessageType::TASKS, 0, std::move(buffer));
 }
 
 void IPCClient::send_mode(const std::string& mode) {
-    std::ostringstream ss;
-    ss << "{\"type\":\"mode\",\"value\":\"" << json_escape(mode) << "\"}";
-    send_message(ss.str());
+    if (!_connected) return;
+    std::string buffer = acquire_buffer();
+    JsonWriter json(buffer);
+    json.begin_object().key("type").value("mode").key("value").value(mode).end_object();
+    send_message(std::move(buffer));
+}
+
+void IPCClient::set_telemetry_rate(uint32_t hz) {
+    _flush_interval_ms = hz > 0 ? std::max<uint32_t>(1000 / hz, 1) : DEFAULT_FLUSH_INTERVAL_MS;
+}
+
+uint64_t IPCClient::get_dropped_count() {
+    return _dropped;
+}
+
+bool IPCClient::screen_pending() {
+    return _latest_pending;
+}
+
+bool IPCClient::consume_screen_drop() {
+    return _screen_dropped.exchange(false);
 }
 
 void IPCClient::process_messages() {
@@ -349,4 +968,9 @@ void IPCClient::set_auto_select_callback(AutoSelectCallback callback) {
     _auto_select_callback = callback;
 }
 
+void IPCClient::set_keyframe_callback(KeyframeCallback callback) {
+    std::lock_guard<std::mutex> lock(_callback_mutex);
+    _keyframe_callback = callback;
+}
+
 } // namespace host
@@ -0,0 +1,284 @@
+/**
+ * @file json_reader.cpp
+ * @brief Event-based JSON Parser Implementation for Host Mode
+ */
+
+#include "host/json_reader.hpp"
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+namespace host {
+
+bool JsonReader::parse(std::string_view json, JsonHandler& handler) {
+    _pos = json.data();
+    _end = json.data() + json.size();
+
+    skip_whitespace();
+    if (!parse_value(handler, 0)) return false;
+    skip_whitespace();
+    return _pos == _end;
+}
+
+void JsonReader::skip_whitespace() {
+    while (_pos < _end && (*_pos == ' ' || *_pos == '\t' || *_pos == '\n' || *_pos == '\r')) {
+        _pos++;
+    }
+}
+
+bool JsonReader::parse_value(JsonHandler& handler, size_t depth) {
+    if (_pos >= _end) return false;
+
+    switch (*_pos) {
+        case '{':
+            return parse_object(handler, depth + 1);
+        case '[':
+            return parse_array(handler, depth + 1);
+        case '"': {
+            std::string_view value;
+            if (!parse_string(value)) return false;
+            handler.string_value(value);
+            return true;
+        }
+        case 't':
+            if (!parse_literal("true")) return false;
+            handler.bool_value(true);
+            return true;
+        case 'f':
+            if (!parse_literal("false")) return false;
+            handler.bool_value(false);
+            return true;
+        case 'n':
+            if (!parse_literal("null")) return false;
+            handler.null_value();
+            return true;
+        default: {
+            double value;
+            if (!parse_number(value)) return false;
+            handler.number_value(value);
+            return true;
+        }
+    }
+}
+
+bool JsonReader::parse_object(JsonHandler& handler, size_t depth) {
+    if (depth > MAX_DEPTH) return false;
+    _pos++;  // '{'
+    handler.begin_object();
+
+    skip_whitespace();
+    if (_pos < _end && *_pos == '}') {
+        _pos++;
+        handler.end_object();
+        return true;
+    }
+
+    while (true) {
+        skip_whitespace();
+        std::string_view name;
+        if (_pos >= _end || *_pos != '"' || !parse_string(name)) return false;
+        handler.key(name);
+
+        skip_whitespace();
+        if (_pos >= _end || *_pos != ':') return false;
+        _pos++;
+        skip_whitespace();
+        if (!parse_value(handler, depth)) return false;
+
+        skip_whitespace();
+        if (_pos >= _end) return false;
+        if (*_pos == ',') {
+            _pos++;
+            continue;
+        }
+        if (*_pos != '}') return false;
+        _pos++;
+        handler.end_object();
+        return true;
+    }
+}
+
+bool JsonReader::parse_array(JsonHandler& handler, size_t depth) {
+    if (depth > MAX_DEPTH) return false;
+    _pos++;  // '['
+    handler.begin_array();
+
+    skip_whitespace();
+    if (_pos < _end && *_pos == ']') {
+        _pos++;
+        handler.end_array();
+        return true;
+    }
+
+    while (true) {
+        skip_whitespace();
+        if (!parse_value(handler, depth)) return false;
+
+        skip_whitespace();
+        if (_pos >= _end) return false;
+        if (*_pos == ',') {
+            _pos++;
+            continue;
+        }
+        if (*_pos != ']') return false;
+        _pos++;
+        handler.end_array();
+        return true;
+    }
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool read_hex4(const char* p, uint32_t& out) {
+    out = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = hex_digit(p[i]);
+        if (digit < 0) return false;
+        out = (out << 4) | static_cast<uint32_t>(digit);
+    }
+    return true;
+}
+
+bool JsonReader::parse_string(std::string_view& out) {
+    _pos++;  // opening quote
+    const char* start = _pos;
+
+    // Fast path: no escapes, hand out a view into the input
+    while (_pos < _end && *_pos != '"' && *_pos != '\\') {
+        if (static_cast<unsigned char>(*_pos) < 0x20) return false;
+        _pos++;
+    }
+    if (_pos >= _end) return false;
+    if (*_pos == '"') {
+        out = std::string_view(start, static_cast<size_t>(_pos - start));
+        _pos++;
+        return true;
+    }
+
+    // Escaped string: decode into the scratch buffer
+    size_t len = static_cast<size_t>(_pos - start);
+    if (len > sizeof(_scratch)) return false;
+    memcpy(_scratch, start, len);
+
+    while (true) {
+        if (_pos >= _end) return false;
+        char c = *_pos++;
+        if (c == '"') break;
+        if (static_cast<unsigned char>(c) < 0x20) return false;
+
+        if (c != '\\') {
+            if (len >= sizeof(_scratch)) return false;
+            _scratch[len++] = c;
+            continue;
+        }
+
+        if (_pos >= _end) return false;
+        char escape = *_pos++;
+        char decoded;
+        switch (escape) {
+            case '"': decoded = '"'; break;
+            case '\\': decoded = '\\'; break;
+            case '/': decoded = '/'; break;
+            case 'b': decoded = '\b'; break;
+            case 'f': decoded = '\f'; break;
+            case 'n': decoded = '\n'; break;
+            case 'r': decoded = '\r'; break;
+            case 't': decoded = '\t'; break;
+            case 'u': {
+                uint32_t code;
+                if (_end - _pos < 4 || !read_hex4(_pos, code)) return false;
+                _pos += 4;
+
+                // Combine a surrogate pair into one code point
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    uint32_t low;
+                    if (_end - _pos < 6 || _pos[0] != '\\' || _pos[1] != 'u' ||
+                        !read_hex4(_pos + 2, low) || low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    _pos += 6;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                // Encode as UTF-8
+                char utf8[4];
+                size_t n;
+                if (code < 0x80) {
+                    utf8[0] = static_cast<char>(code);
+                    n = 1;
+                } else if (code < 0x800) {
+                    utf8[0] = static_cast<char>(0xC0 | (code >> 6));
+                    utf8[1] = static_cast<char>(0x80 | (code & 0x3F));
+                    n = 2;
+                } else if (code < 0x10000) {
+                    utf8[0] = static_cast<char>(0xE0 | (code >> 12));
+                    utf8[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    utf8[2] = static_cast<char>(0x80 | (code & 0x3F));
+                    n = 3;
+                } else {
+                    utf8[0] = static_cast<char>(0xF0 | (code >> 18));
+                    utf8[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    utf8[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    utf8[3] = static_cast<char>(0x80 | (code & 0x3F));
+                    n = 4;
+                }
+                if (len + n > sizeof(_scratch)) return false;
+                memcpy(_scratch + len, utf8, n);
+                len += n;
+                continue;
+            }
+            default:
+                return false;
+        }
+        if (len >= sizeof(_scratch)) return false;
+        _scratch[len++] = decoded;
+    }
+
+    out = std::string_view(_scratch, len);
+    return true;
+}
+
+bool JsonReader::parse_number(double& out) {
+    // Validate the JSON number grammar, which is stricter than from_chars
+    const char* start = _pos;
+    const char* p = _pos;
+    if (p < _end && *p == '-') p++;
+    if (p >= _end) return false;
+    if (*p == '0') {
+        p++;
+    } else if (*p >= '1' && *p <= '9') {
+        while (p < _end && *p >= '0' && *p <= '9') p++;
+    } else {
+        return false;
+    }
+    if (p < _end && *p == '.') {
+        p++;
+        if (p >= _end || *p < '0' || *p > '9') return false;
+        while (p < _end && *p >= '0' && *p <= '9') p++;
+    }
+    if (p < _end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < _end && (*p == '+' || *p == '-')) p++;
+        if (p >= _end || *p < '0' || *p > '9') return false;
+        while (p < _end && *p >= '0' && *p <= '9') p++;
+    }
+
+    auto result = std::from_chars(start, p, out);
+    if (result.ec != std::errc() || result.ptr != p) return false;
+    _pos = p;
+    return true;
+}
+
+bool JsonReader::parse_literal(const char* literal) {
+    size_t len = strlen(literal);
+    if (static_cast<size_t>(_end - _pos) < len || memcmp(_pos, literal, len) != 0) return false;
+    _pos += len;
+    return true;
+}
+
+} // namespace host
@@ -0,0 +1,141 @@
+/**
+ * @file json_writer.cpp
+ * @brief Streaming JSON Writer Implementation for Host Mode
+ */
+
+#include "host/json_writer.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace host {
+
+void JsonWriter::separator() {
+    // A value right after its key needs no comma
+    if (_after_key) {
+        _after_key = false;
+        return;
+    }
+    if (_depth == 0) return;
+
+    uint32_t bit = 1u << ((_depth - 1) & 31);
+    if (_first & bit) {
+        _first &= ~bit;
+    } else {
+        _out += ',';
+    }
+}
+
+void JsonWriter::push() {
+    _depth++;
+    _first |= 1u << ((_depth - 1) & 31);
+}
+
+void JsonWriter::pop() {
+    if (_depth > 0) _depth--;
+}
+
+JsonWriter& JsonWriter::begin_object() {
+    separator();
+    _out += '{';
+    push();
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_object() {
+    _out += '}';
+    pop();
+    return *this;
+}
+
+JsonWriter& JsonWriter::begin_array() {
+    separator();
+    _out += '[';
+    push();
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_array() {
+    _out += ']';
+    pop();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+    separator();
+    write_string(name, strlen(name));
+    _out += ':';
+    _after_key = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* s) {
+    separator();
+    write_string(s, strlen(s));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& s) {
+    separator();
+    write_string(s.data(), s.size());
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+    separator();
+    _out += b ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double d) {
+    separator();
+    if (!std::isfinite(d)) {
+        _out += "null";
+        return *this;
+    }
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), d, std::chars_format::general, 6);
+    _out.append(buffer, static_cast<size_t>(result.ptr - buffer));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value_integer(int64_t v) {
+    separator();
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), v);
+    _out.append(buffer, static_cast<size_t>(result.ptr - buffer));
+    return *this;
+}
+
+void JsonWriter::write_string(const char* s, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+
+    _out += '"';
+
+    // Copy runs of plain characters in one append
+    size_t run = 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        _out.append(s + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"': _out += "\\\""; break;
+            case '\\': _out += "\\\\"; break;
+            case '\n': _out += "\\n"; break;
+            case '\r': _out += "\\r"; break;
+            case '\t': _out += "\\t"; break;
+            default: {
+                char escape[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                _out.append(escape, sizeof(escape));
+                break;
+            }
+        }
+    }
+    _out.append(s + run, len - run);
+
+    _out += '"';
+}
+
+} // namespace host
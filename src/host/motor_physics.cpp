@@ -0,0 +1,61 @@
+/**
+ * @file motor_physics.cpp
+ * @brief Batched Motor Physics Implementation for Host Mode
+ */
+
+#include "host/motor_physics.hpp"
+#include <cmath>
+
+namespace host {
+
+// Model constants
+static constexpr double VELOCITY_TIME_CONSTANT_MS = 94.91;  // Closes 10% of the gap per 10 ms
+static constexpr double FULL_SPEED_CURRENT_MA = 2000.0;      // Draw at max velocity, scaled by |v| / max
+static constexpr double AMBIENT_TEMPERATURE = 25.0;
+static constexpr double TEMPERATURE_PER_MA = 30.0 / 2500.0;
+static constexpr double DEGREES_PER_RPM_MS = 360.0 / 60000.0;
+
+MotorLanes::MotorLanes() {
+    for (size_t i = 0; i < LANES; i++) {
+        temperature[i] = AMBIENT_TEMPERATURE;
+    }
+}
+
+double motor_max_velocity(pros::motor_gearset_e_t gearset) {
+    switch (gearset) {
+        case pros::E_MOTOR_GEARSET_36: return 100.0;
+        case pros::E_MOTOR_GEARSET_06: return 600.0;
+        case pros::E_MOTOR_GEARSET_18:
+        default: return 200.0;
+    }
+}
+
+void step_motors(MotorLanes& lanes, double dt_ms) {
+    const double* __restrict voltage = lanes.voltage;
+    const double* __restrict max_velocity = lanes.max_velocity;
+    const double* __restrict inv_max_velocity = lanes.inv_max_velocity;
+    const double* __restrict active = lanes.active;
+    double* __restrict velocity = lanes.velocity;
+    double* __restrict position = lanes.position;
+    double* __restrict current = lanes.current;
+    double* __restrict temperature = lanes.temperature;
+
+    // Exact first-order response for this step length, so results do not
+    // depend on how time is sliced into steps
+    const double alpha = 1.0 - std::exp(-dt_ms / VELOCITY_TIME_CONSTANT_MS);
+    const double position_scale = dt_ms * DEGREES_PER_RPM_MS;
+
+    // Inactive lanes are masked out by multiplying their change by 0.0
+    for (size_t i = 0; i < MotorLanes::LANES; i++) {
+        double target = voltage[i] * (1.0 / 127.0) * max_velocity[i];
+        double v = velocity[i] + active[i] * alpha * (target - velocity[i]);
+        velocity[i] = v;
+        position[i] += active[i] * v * position_scale;
+
+        double draw = std::fabs(v) * inv_max_velocity[i] * FULL_SPEED_CURRENT_MA;
+        current[i] += active[i] * (draw - current[i]);
+        temperature[i] += active[i] * (AMBIENT_TEMPERATURE + draw * TEMPERATURE_PER_MA - temperature[i]);
+    }
+}
+
+} // namespace host
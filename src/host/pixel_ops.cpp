@@ -0,0 +1,428 @@
+/**
+ * @file pixel_ops.cpp
+ * @brief Vectorized RGB565 pixel kernels for host mode drawing
+ */
+
+#include "host/pixel_ops.hpp"
+#include <atomic>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PIXEL_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PIXEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang compile the AVX2 (and, on 32-bit x86, SSE2) kernels for their
+// instruction set without raising the baseline of the whole build
+#if defined(PIXEL_X86) && defined(__GNUC__)
+#define PIXEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PIXEL_TARGET(isa)
+#endif
+
+namespace host {
+
+struct PixelKernels {
+    PixelIsa isa;
+    void (*fill)(uint16_t* dst, uint16_t color, size_t count);
+    void (*blend)(uint16_t* dst, uint16_t color, uint8_t opa, size_t count);
+    void (*to_rgba8888)(uint32_t* dst, const uint16_t* src, size_t count);
+};
+
+// x / 255 for x <= 255 * 63, exact, without a division (the SIMD versions
+// use the same steps)
+static inline uint32_t div255(uint32_t x) {
+    x += 1;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline uint16_t blend_pixel(uint16_t px, uint32_t fr, uint32_t fg, uint32_t fb, uint32_t inv) {
+    uint32_t r = div255(fr + (px >> 11) * inv);
+    uint32_t g = div255(fg + ((px >> 5) & 0x3F) * inv);
+    uint32_t b = div255(fb + (px & 0x1F) * inv);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static inline uint32_t rgba_pixel(uint16_t px) {
+    uint32_t r = (px >> 11) << 3;
+    uint32_t g = ((px >> 5) & 0x3F) << 2;
+    uint32_t b = (px & 0x1F) << 3;
+    return 0xFF000000u | (b << 16) | (g << 8) | r;
+}
+
+// ============================================================================
+// Scalar
+// ============================================================================
+
+static void fill_scalar(uint16_t* dst, uint16_t color, size_t count) {
+    for (size_t i = 0; i < count; i++) dst[i] = color;
+}
+
+static void blend_scalar(uint16_t* dst, uint16_t color, uint8_t opa, size_t count) {
+    uint32_t inv = 255 - opa;
+    uint32_t fr = (color >> 11) * opa;
+    uint32_t fg = ((color >> 5) & 0x3F) * opa;
+    uint32_t fb = (color & 0x1F) * opa;
+    for (size_t i = 0; i < count; i++) dst[i] = blend_pixel(dst[i], fr, fg, fb, inv);
+}
+
+static void to_rgba8888_scalar(uint32_t* dst, const uint16_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) dst[i] = rgba_pixel(src[i]);
+}
+
+// ============================================================================
+// SSE2 / AVX2
+// ============================================================================
+
+#ifdef PIXEL_X86
+
+PIXEL_TARGET("sse2")
+static void fill_sse2(uint16_t* dst, uint16_t color, size_t count) {
+    __m128i c = _mm_set1_epi16(static_cast<short>(color));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), c);
+    for (; i < count; i++) dst[i] = color;
+}
+
+PIXEL_TARGET("sse2")
+static inline __m128i div255_sse2(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(1));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+PIXEL_TARGET("sse2")
+static void blend_sse2(uint16_t* dst, uint16_t color, uint8_t opa, size_t count) {
+    uint32_t inv = 255 - opa;
+    uint32_t fr = (color >> 11) * opa;
+    uint32_t fg = ((color >> 5) & 0x3F) * opa;
+    uint32_t fb = (color & 0x1F) * opa;
+
+    __m128i vinv = _mm_set1_epi16(static_cast<short>(inv));
+    __m128i vfr = _mm_set1_epi16(static_cast<short>(fr));
+    __m128i vfg = _mm_set1_epi16(static_cast<short>(fg));
+    __m128i vfb = _mm_set1_epi16(static_cast<short>(fb));
+    __m128i mask6 = _mm_set1_epi16(0x3F);
+    __m128i mask5 = _mm_set1_epi16(0x1F);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i r = _mm_srli_epi16(px, 11);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(px, 5), mask6);
+        __m128i b = _mm_and_si128(px, mask5);
+        r = div255_sse2(_mm_add_epi16(vfr, _mm_mullo_epi16(r, vinv)));
+        g = div255_sse2(_mm_add_epi16(vfg, _mm_mullo_epi16(g, vinv)));
+        b = div255_sse2(_mm_add_epi16(vfb, _mm_mullo_epi16(b, vinv)));
+        __m128i out = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+    }
+    for (; i < count; i++) dst[i] = blend_pixel(dst[i], fr, fg, fb, inv);
+}
+
+PIXEL_TARGET("sse2")
+static void to_rgba8888_sse2(uint32_t* dst, const uint16_t* src, size_t count) {
+    __m128i mask_g = _mm_set1_epi16(0x3F << 2);
+    __m128i mask_b = _mm_set1_epi16(0x1F << 3);
+    __m128i alpha = _mm_set1_epi16(static_cast<short>(0xFF00));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i r = _mm_slli_epi16(_mm_srli_epi16(px, 11), 3);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(px, 3), mask_g);
+        __m128i b = _mm_and_si128(_mm_slli_epi16(px, 3), mask_b);
+        // 16-bit lanes holding the R,G and B,A byte pairs, interleaved into pixels
+        __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        __m128i ba = _mm_or_si128(b, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(rg, ba));
+    }
+    for (; i < count; i++) dst[i] = rgba_pixel(src[i]);
+}
+
+// The AVX2 kernels finish with an 8-pixel step, so short spans (such as 40
+// pixels = 2 x 16 + 8) do not spend half their time in scalar code. Calling
+// the SSE2 kernels for it instead would mix VEX and legacy SSE encodings and
+// pay for the state transition on every call.
+
+PIXEL_TARGET("avx2")
+static void fill_avx2(uint16_t* dst, uint16_t color, size_t count) {
+    __m256i c = _mm256_set1_epi16(static_cast<short>(color));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), c);
+    if (i + 8 <= count) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(c));
+        i += 8;
+    }
+    for (; i < count; i++) dst[i] = color;
+}
+
+PIXEL_TARGET("avx2")
+static inline __m256i div255_avx2(__m256i x) {
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(1));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+PIXEL_TARGET("avx2")
+static void blend_avx2(uint16_t* dst, uint16_t color, uint8_t opa, size_t count) {
+    uint32_t inv = 255 - opa;
+    uint32_t fr = (color >> 11) * opa;
+    uint32_t fg = ((color >> 5) & 0x3F) * opa;
+    uint32_t fb = (color & 0x1F) * opa;
+
+    __m256i vinv = _mm256_set1_epi16(static_cast<short>(inv));
+    __m256i vfr = _mm256_set1_epi16(static_cast<short>(fr));
+    __m256i vfg = _mm256_set1_epi16(static_cast<short>(fg));
+    __m256i vfb = _mm256_set1_epi16(static_cast<short>(fb));
+    __m256i mask6 = _mm256_set1_epi16(0x3F);
+    __m256i mask5 = _mm256_set1_epi16(0x1F);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i r = _mm256_srli_epi16(px, 11);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(px, 5), mask6);
+        __m256i b = _mm256_and_si256(px, mask5);
+        r = div255_avx2(_mm256_add_epi16(vfr, _mm256_mullo_epi16(r, vinv)));
+        g = div255_avx2(_mm256_add_epi16(vfg, _mm256_mullo_epi16(g, vinv)));
+        b = div255_avx2(_mm256_add_epi16(vfb, _mm256_mullo_epi16(b, vinv)));
+        __m256i out = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r, 11), _mm256_slli_epi16(g, 5)), b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+    }
+    if (i + 8 <= count) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i r = _mm_srli_epi16(px, 11);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(px, 5), _mm256_castsi256_si128(mask6));
+        __m128i b = _mm_and_si128(px, _mm256_castsi256_si128(mask5));
+        __m128i one = _mm_set1_epi16(1);
+        r = _mm_add_epi16(_mm_add_epi16(_mm256_castsi256_si128(vfr), _mm_mullo_epi16(r, _mm256_castsi256_si128(vinv))), one);
+        g = _mm_add_epi16(_mm_add_epi16(_mm256_castsi256_si128(vfg), _mm_mullo_epi16(g, _mm256_castsi256_si128(vinv))), one);
+        b = _mm_add_epi16(_mm_add_epi16(_mm256_castsi256_si128(vfb), _mm_mullo_epi16(b, _mm256_castsi256_si128(vinv))), one);
+        r = _mm_srli_epi16(_mm_add_epi16(r, _mm_srli_epi16(r, 8)), 8);
+        g = _mm_srli_epi16(_mm_add_epi16(g, _mm_srli_epi16(g, 8)), 8);
+        b = _mm_srli_epi16(_mm_add_epi16(b, _mm_srli_epi16(b, 8)), 8);
+        __m128i out = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+        i += 8;
+    }
+    for (; i < count; i++) dst[i] = blend_pixel(dst[i], fr, fg, fb, inv);
+}
+
+PIXEL_TARGET("avx2")
+static void to_rgba8888_avx2(uint32_t* dst, const uint16_t* src, size_t count) {
+    __m256i mask_g = _mm256_set1_epi16(0x3F << 2);
+    __m256i mask_b = _mm256_set1_epi16(0x1F << 3);
+    __m256i alpha = _mm256_set1_epi16(static_cast<short>(0xFF00));
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i r = _mm256_slli_epi16(_mm256_srli_epi16(px, 11), 3);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(px, 3), mask_g);
+        __m256i b = _mm256_and_si256(_mm256_slli_epi16(px, 3), mask_b);
+        __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+        __m256i ba = _mm256_or_si256(b, alpha);
+        // Unpacking works within 128-bit lanes, so put the halves back in order
+        __m256i lo = _mm256_unpacklo_epi16(rg, ba);
+        __m256i hi = _mm256_unpackhi_epi16(rg, ba);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    for (; i < count; i++) dst[i] = rgba_pixel(src[i]);
+}
+
+static bool cpu_has_sse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;  // Part of the x86-64 baseline
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static bool cpu_has_avx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5));
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // PIXEL_X86
+
+// ============================================================================
+// NEON
+// ============================================================================
+
+#ifdef PIXEL_NEON
+
+static void fill_neon(uint16_t* dst, uint16_t color, size_t count) {
+    uint16x8_t c = vdupq_n_u16(color);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) vst1q_u16(dst + i, c);
+    for (; i < count; i++) dst[i] = color;
+}
+
+static inline uint16x8_t div255_neon(uint16x8_t x) {
+    x = vaddq_u16(x, vdupq_n_u16(1));
+    return vshrq_n_u16(vsraq_n_u16(x, x, 8), 8);
+}
+
+static void blend_neon(uint16_t* dst, uint16_t color, uint8_t opa, size_t count) {
+    uint32_t inv = 255 - opa;
+    uint32_t fr = (color >> 11) * opa;
+    uint32_t fg = ((color >> 5) & 0x3F) * opa;
+    uint32_t fb = (color & 0x1F) * opa;
+
+    uint16x8_t vinv = vdupq_n_u16(static_cast<uint16_t>(inv));
+    uint16x8_t vfr = vdupq_n_u16(static_cast<uint16_t>(fr));
+    uint16x8_t vfg = vdupq_n_u16(static_cast<uint16_t>(fg));
+    uint16x8_t vfb = vdupq_n_u16(static_cast<uint16_t>(fb));
+    uint16x8_t mask6 = vdupq_n_u16(0x3F);
+    uint16x8_t mask5 = vdupq_n_u16(0x1F);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t px = vld1q_u16(dst + i);
+        uint16x8_t r = div255_neon(vmlaq_u16(vfr, vshrq_n_u16(px, 11), vinv));
+        uint16x8_t g = div255_neon(vmlaq_u16(vfg, vandq_u16(vshrq_n_u16(px, 5), mask6), vinv));
+        uint16x8_t b = div255_neon(vmlaq_u16(vfb, vandq_u16(px, mask5), vinv));
+        vst1q_u16(dst + i, vorrq_u16(vorrq_u16(vshlq_n_u16(r, 11), vshlq_n_u16(g, 5)), b));
+    }
+    for (; i < count; i++) dst[i] = blend_pixel(dst[i], fr, fg, fb, inv);
+}
+
+static void to_rgba8888_neon(uint32_t* dst, const uint16_t* src, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t px = vld1q_u16(src + i);
+        uint8x8x4_t out;
+        out.val[0] = vshl_n_u8(vmovn_u16(vshrq_n_u16(px, 11)), 3);
+        out.val[1] = vshl_n_u8(vmovn_u16(vshrq_n_u16(px, 5)), 2);
+        out.val[2] = vshl_n_u8(vmovn_u16(px), 3);
+        out.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), out);
+    }
+    for (; i < count; i++) dst[i] = rgba_pixel(src[i]);
+}
+
+#endif // PIXEL_NEON
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+static const PixelKernels scalar_kernels = {PixelIsa::SCALAR, fill_scalar, blend_scalar, to_rgba8888_scalar};
+#ifdef PIXEL_X86
+static const PixelKernels sse2_kernels = {PixelIsa::SSE2, fill_sse2, blend_sse2, to_rgba8888_sse2};
+static const PixelKernels avx2_kernels = {PixelIsa::AVX2, fill_avx2, blend_avx2, to_rgba8888_avx2};
+#endif
+#ifdef PIXEL_NEON
+static const PixelKernels neon_kernels = {PixelIsa::NEON, fill_neon, blend_neon, to_rgba8888_neon};
+#endif
+
+// Chosen on first use, so kernels work even from static initializers
+static std::atomic<const PixelKernels*> active_kernels{nullptr};
+
+static const PixelKernels* kernels_for(PixelIsa isa) {
+    switch (isa) {
+        case PixelIsa::SCALAR:
+            return &scalar_kernels;
+#ifdef PIXEL_X86
+        case PixelIsa::SSE2:
+            return cpu_has_sse2() ? &sse2_kernels : nullptr;
+        case PixelIsa::AVX2:
+            return cpu_has_avx2() ? &avx2_kernels : nullptr;
+#endif
+#ifdef PIXEL_NEON
+        case PixelIsa::NEON:
+            return &neon_kernels;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+static const PixelKernels& kernels() {
+    const PixelKernels* k = active_kernels.load(std::memory_order_relaxed);
+    if (!k) {
+        for (PixelIsa isa : {PixelIsa::AVX2, PixelIsa::SSE2, PixelIsa::NEON, PixelIsa::SCALAR}) {
+            if ((k = kernels_for(isa))) break;
+        }
+        active_kernels.store(k, std::memory_order_relaxed);
+    }
+    return *k;
+}
+
+PixelIsa pixel_isa() {
+    return kernels().isa;
+}
+
+bool pixel_isa_supported(PixelIsa isa) {
+    return kernels_for(isa) != nullptr;
+}
+
+bool set_pixel_isa(PixelIsa isa) {
+    const PixelKernels* k = kernels_for(isa);
+    if (!k) return false;
+    active_kernels.store(k, std::memory_order_relaxed);
+    return true;
+}
+
+const char* pixel_isa_name(PixelIsa isa) {
+    switch (isa) {
+        case PixelIsa::SCALAR: return "scalar";
+        case PixelIsa::SSE2:   return "sse2";
+        case PixelIsa::AVX2:   return "avx2";
+        case PixelIsa::NEON:   return "neon";
+    }
+    return "unknown";
+}
+
+void pixel_fill(uint16_t* dst, uint16_t color, size_t count) {
+    kernels().fill(dst, color, count);
+}
+
+void pixel_blend(uint16_t* dst, uint16_t color, uint8_t opa, size_t count) {
+    if (opa == 0) return;
+    if (opa == 255) {
+        kernels().fill(dst, color, count);
+        return;
+    }
+    kernels().blend(dst, color, opa, count);
+}
+
+void pixel_copy(uint16_t* dst, size_t dst_stride, const uint16_t* src, size_t src_stride,
+                size_t width, size_t height) {
+    // memcpy is already vectorized (and picks non-temporal stores for large
+    // blocks), so rows are handed to it directly
+    if (width == dst_stride && width == src_stride) {
+        std::memcpy(dst, src, width * height * sizeof(uint16_t));
+        return;
+    }
+    for (size_t y = 0; y < height; y++) {
+        std::memcpy(dst + y * dst_stride, src + y * src_stride, width * sizeof(uint16_t));
+    }
+}
+
+void pixel_to_rgba8888(uint32_t* dst, const uint16_t* src, size_t count) {
+    kernels().to_rgba8888(dst, src, count);
+}
+
+} // namespace host
@@ -0,0 +1,492 @@
+/**
+ * @file renderer.cpp
+ * @brief Software Renderer Implementation for Host Mode
+ */
+
+#include "host/renderer.hpp"
+#include "host/pixel_ops.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// 5x7 glyphs for ASCII 32-126, one byte per column (bit 0 = top row)
+static const uint8_t FONT_5X7[95][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00},
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00},
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E},
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x01, 0x01},
+    {0x3E, 0x41, 0x41, 0x51, 0x32}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+    {0x7F, 0x02, 0x04, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x7F, 0x20, 0x18, 0x20, 0x7F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04},
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78},
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F},
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x08, 0x54, 0x54, 0x54, 0x3C},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00},
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08},
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00},
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x08, 0x04, 0x08, 0x10, 0x08},
+};
+
+static constexpr int GLYPH_W = 5;
+static constexpr int GLYPH_H = 7;
+
+// The stub fonts only carry metrics, so text is drawn with the built-in
+// glyphs at the integer scale closest to the font's size
+static int font_scale(const lv_font_t* font) {
+    return font && font->line_height >= 14 ? 2 : 1;
+}
+
+static lv_coord_t font_line_height(const lv_font_t* font) {
+    lv_coord_t glyph = (GLYPH_H + 1) * font_scale(font);
+    return font ? std::max<lv_coord_t>(font->line_height, glyph) : glyph;
+}
+
+void lv_txt_get_size(lv_point_t* size_res, const char* text, const lv_font_t* font,
+                     lv_coord_t letter_space, lv_coord_t line_space, lv_coord_t max_width, uint8_t flag) {
+    // Lines only break at '\n'; max_width and flag are not supported
+    (void)max_width;
+    (void)flag;
+    lv_coord_t advance = (GLYPH_W + 1) * font_scale(font) + letter_space;
+    lv_coord_t width = 0, line_width = 0, lines = 1;
+    for (const char* c = text ? text : ""; *c; c++) {
+        if (*c == '\n') {
+            lines++;
+            line_width = 0;
+            continue;
+        }
+        line_width += advance;
+        width = std::max(width, line_width);
+    }
+
+    // No spacing after the last glyph of a line
+    size_res->x = width > 0 ? width - font_scale(font) - letter_space : 0;
+    size_res->y = lines * font_line_height(font) + (lines - 1) * line_space;
+}
+
+namespace host {
+
+// One render pass: a strip of the screen backed by the draw buffer
+struct DrawCtx {
+    lv_color_t* buf;
+    lv_area_t area;     // Screen area the buffer holds
+    lv_coord_t stride;
+};
+
+static bool area_intersect(const lv_area_t& a, const lv_area_t& b, lv_area_t& out) {
+    out = {std::max(a.x1, b.x1), std::max(a.y1, b.y1), std::min(a.x2, b.x2), std::min(a.y2, b.y2)};
+    return out.x1 <= out.x2 && out.y1 <= out.y2;
+}
+
+static int32_t area_size(const lv_area_t& a) {
+    return (a.x2 - a.x1 + 1) * (a.y2 - a.y1 + 1);
+}
+
+// Blends a horizontal run of pixels; x1..x2 are clipped to clip here
+static void fill_span(const DrawCtx& ctx, const lv_area_t& clip, lv_coord_t y, lv_coord_t x1, lv_coord_t x2,
+                      lv_color_t color, lv_opa_t opa) {
+    x1 = std::max(x1, clip.x1);
+    x2 = std::min(x2, clip.x2);
+    if (x1 > x2 || y < clip.y1 || y > clip.y2) return;
+
+    lv_color_t* px = ctx.buf + (y - ctx.area.y1) * ctx.stride + (x1 - ctx.area.x1);
+    pixel_blend(&px->full, color.full, opa, x2 - x1 + 1);
+}
+
+// How far a rounded corner pulls row `row` of an h-pixel-high shape inwards
+static lv_coord_t corner_inset(lv_coord_t radius, lv_coord_t row, lv_coord_t h) {
+    if (radius <= 0) return 0;
+    float dy;
+    if (row < radius) dy = radius - row - 0.5f;
+    else if (row >= h - radius) dy = row - (h - radius) + 0.5f;
+    else return 0;
+    float dx = std::sqrt(std::max(0.0f, radius * radius - dy * dy));
+    return radius - static_cast<lv_coord_t>(dx + 0.5f);
+}
+
+// Draws a rectangle with optional rounded corners, background and border
+static void draw_rect(const DrawCtx& ctx, const lv_area_t& coords, const lv_area_t& clip,
+                      lv_coord_t radius, lv_color_t bg, lv_opa_t bg_opa,
+                      lv_color_t border, lv_coord_t border_width) {
+    lv_coord_t w = coords.x2 - coords.x1 + 1;
+    lv_coord_t h = coords.y2 - coords.y1 + 1;
+    lv_coord_t r = std::min<lv_coord_t>(radius, std::min(w, h) / 2);
+    lv_coord_t bw = std::min<lv_coord_t>(border_width, std::min(w, h) / 2);
+    lv_coord_t ir = std::max<lv_coord_t>(0, r - bw);
+    lv_area_t inner = {static_cast<lv_coord_t>(coords.x1 + bw), static_cast<lv_coord_t>(coords.y1 + bw),
+                       static_cast<lv_coord_t>(coords.x2 - bw), static_cast<lv_coord_t>(coords.y2 - bw)};
+    lv_coord_t ih = inner.y2 - inner.y1 + 1;
+
+    lv_coord_t y1 = std::max(coords.y1, clip.y1);
+    lv_coord_t y2 = std::min(coords.y2, clip.y2);
+    for (lv_coord_t y = y1; y <= y2; y++) {
+        lv_coord_t inset = corner_inset(r, y - coords.y1, h);
+        lv_coord_t ox1 = coords.x1 + inset, ox2 = coords.x2 - inset;
+
+        if (bw <= 0) {
+            if (bg_opa > LV_OPA_TRANSP) fill_span(ctx, clip, y, ox1, ox2, bg, bg_opa);
+            continue;
+        }
+        if (y < inner.y1 || y > inner.y2) {
+            fill_span(ctx, clip, y, ox1, ox2, border, LV_OPA_COVER);
+            continue;
+        }
+        lv_coord_t iinset = corner_inset(ir, y - inner.y1, ih);
+        lv_coord_t ix1 = inner.x1 + iinset, ix2 = inner.x2 - iinset;
+        fill_span(ctx, clip, y, ox1, ix1 - 1, border, LV_OPA_COVER);
+        fill_span(ctx, clip, y, ix2 + 1, ox2, border, LV_OPA_COVER);
+        if (bg_opa > LV_OPA_TRANSP) fill_span(ctx, clip, y, ix1, ix2, bg, bg_opa);
+    }
+}
+
+// Draws text with its top-left corner at (x, y)
+static void draw_text(const DrawCtx& ctx, const lv_area_t& clip, lv_coord_t x, lv_coord_t y,
+                      const char* text, const lv_font_t* font, lv_color_t color) {
+    int scale = font_scale(font);
+    lv_coord_t line_height = font_line_height(font);
+    lv_coord_t top = y + (line_height - GLYPH_H * scale) / 2;
+    lv_coord_t left = x;
+
+    for (const char* c = text; *c; c++) {
+        if (*c == '\n') {
+            top += line_height;
+            left = x;
+            continue;
+        }
+        int index = (*c >= 32 && *c <= 126) ? *c - 32 : '?' - 32;
+
+        // Skip glyphs entirely outside the clip area
+        lv_area_t cell = {left, top, static_cast<lv_coord_t>(left + GLYPH_W * scale - 1),
+                          static_cast<lv_coord_t>(top + GLYPH_H * scale - 1)};
+        lv_area_t visible;
+        if (area_intersect(cell, clip, visible)) {
+            for (int col = 0; col < GLYPH_W; col++) {
+                uint8_t bits = FONT_5X7[index][col];
+                for (int row = 0; bits; row++, bits >>= 1) {
+                    if (!(bits & 1)) continue;
+                    lv_coord_t px = left + col * scale;
+                    for (int dy = 0; dy < scale; dy++) {
+                        fill_span(ctx, clip, top + row * scale + dy, px, px + scale - 1, color, LV_OPA_COVER);
+                    }
+                }
+            }
+        }
+        left += (GLYPH_W + 1) * scale;
+    }
+}
+
+// Draws one part of an object (background, border and radius from its style)
+static void draw_part(const DrawCtx& ctx, const lv_obj_t* obj, uint32_t part,
+                      const lv_area_t& coords, const lv_area_t& clip) {
+    lv_opa_t bg_opa = lv_obj_get_style_bg_opa(obj, part);
+    lv_coord_t border_width = lv_obj_get_style_border_width(obj, part);
+    if (bg_opa == LV_OPA_TRANSP && border_width <= 0) return;
+
+    draw_rect(ctx, coords, clip, lv_obj_get_style_radius(obj, part),
+              lv_obj_get_style_bg_color(obj, part), bg_opa,
+              lv_obj_get_style_border_color(obj, part), border_width);
+}
+
+static lv_coord_t style_num(const lv_obj_t* obj, uint32_t part, lv_style_prop_t prop) {
+    return static_cast<lv_coord_t>(lv_obj_get_style_prop(obj, part, prop).num);
+}
+
+static void draw_bar(const DrawCtx& ctx, const lv_obj_t* obj, const lv_area_t& coords, const lv_area_t& clip) {
+    int32_t min = lv_bar_get_min_value(obj);
+    int32_t max = lv_bar_get_max_value(obj);
+    int32_t value = std::max(min, std::min(max, lv_bar_get_value(obj)));
+    if (max <= min || value == min) return;
+
+    // Fills from the left, or from the bottom when taller than wide
+    lv_area_t ind = coords;
+    lv_coord_t w = coords.x2 - coords.x1 + 1;
+    lv_coord_t h = coords.y2 - coords.y1 + 1;
+    if (h > w) {
+        ind.y1 = coords.y2 - static_cast<lv_coord_t>(static_cast<int64_t>(h) * (value - min) / (max - min)) + 1;
+    } else {
+        ind.x2 = coords.x1 + static_cast<lv_coord_t>(static_cast<int64_t>(w) * (value - min) / (max - min)) - 1;
+    }
+    draw_part(ctx, obj, LV_PART_INDICATOR, ind, clip);
+}
+
+static void draw_label(const DrawCtx& ctx, const lv_obj_t* obj, const lv_area_t& coords, const lv_area_t& clip) {
+    const char* text = lv_label_get_text(obj);
+    if (!text || !*text) return;
+    draw_text(ctx, clip, coords.x1, coords.y1, text, lv_obj_get_style_text_font(obj, LV_PART_MAIN),
+              lv_obj_get_style_text_color(obj, LV_PART_MAIN));
+}
+
+// Lays the map out in rows of equally wide buttons
+static void draw_btnmatrix(const DrawCtx& ctx, lv_obj_t* obj, const lv_area_t& coords, const lv_area_t& clip) {
+    const char** map = lv_btnmatrix_get_map(obj);
+    if (!map) return;
+
+    int rows = 1;
+    for (int i = 0; map[i][0]; i++) {
+        if (strcmp(map[i], "\n") == 0) rows++;
+    }
+
+    lv_coord_t pad_left = style_num(obj, LV_PART_MAIN, LV_STYLE_PAD_LEFT);
+    lv_coord_t pad_top = style_num(obj, LV_PART_MAIN, LV_STYLE_PAD_TOP);
+    lv_coord_t gap_x = style_num(obj, LV_PART_MAIN, LV_STYLE_PAD_COLUMN);
+    lv_coord_t gap_y = style_num(obj, LV_PART_MAIN, LV_STYLE_PAD_ROW);
+    lv_coord_t inner_w = coords.x2 - coords.x1 + 1 - pad_left - style_num(obj, LV_PART_MAIN, LV_STYLE_PAD_RIGHT);
+    lv_coord_t inner_h = coords.y2 - coords.y1 + 1 - pad_top - style_num(obj, LV_PART_MAIN, LV_STYLE_PAD_BOTTOM);
+    lv_coord_t row_h = (inner_h - (rows - 1) * gap_y) / rows;
+
+    uint32_t saved_state = obj->state;
+    int entry = 0;
+    uint16_t btn_id = 0;
+    for (int row = 0; row < rows; row++) {
+        int cols = 0;
+        while (map[entry + cols][0] && strcmp(map[entry + cols], "\n") != 0) cols++;
+
+        lv_coord_t y1 = coords.y1 + pad_top + row * (row_h + gap_y);
+        for (int col = 0; col < cols; col++, btn_id++) {
+            if (lv_btnmatrix_has_btn_ctrl(obj, btn_id, LV_BTNMATRIX_CTRL_HIDDEN)) continue;
+            lv_coord_t x1 = coords.x1 + pad_left + inner_w * col / cols;
+            lv_coord_t x2 = coords.x1 + pad_left + inner_w * (col + 1) / cols - 1 - (col + 1 < cols ? gap_x : 0);
+            lv_area_t btn = {x1, y1, x2, static_cast<lv_coord_t>(y1 + row_h - 1)};
+
+            // Item styles are selected by the button's own state, so borrow
+            // the object's state field while drawing it (as LVGL does)
+            obj->state = saved_state & ~LV_STATE_CHECKED;
+            if (lv_btnmatrix_has_btn_ctrl(obj, btn_id, LV_BTNMATRIX_CTRL_CHECKED)) obj->state |= LV_STATE_CHECKED;
+
+            lv_area_t btn_clip;
+            if (area_intersect(btn, clip, btn_clip)) {
+                draw_part(ctx, obj, LV_PART_ITEMS, btn, btn_clip);
+
+                const char* text = map[entry + col];
+                const lv_font_t* font = lv_obj_get_style_text_font(obj, LV_PART_ITEMS);
+                lv_point_t size;
+                lv_txt_get_size(&size, text, font, 0, 0, LV_COORD_MAX, 0);
+                draw_text(ctx, btn_clip, x1 + (x2 - x1 + 1 - size.x) / 2, y1 + (row_h - size.y) / 2,
+                          text, font, lv_obj_get_style_text_color(obj, LV_PART_ITEMS));
+            }
+        }
+        obj->state = saved_state;
+        entry += cols + (map[entry + cols][0] ? 1 : 0);
+    }
+}
+
+// Draws an object and its children, clipped to clip. (x, y) is the parent's
+// top-left corner on the screen.
+static void draw_obj(const DrawCtx& ctx, lv_obj_t* obj, lv_coord_t x, lv_coord_t y, const lv_area_t& clip) {
+    if (obj->flags & LV_OBJ_FLAG_HIDDEN) return;
+
+    lv_area_t coords = {static_cast<lv_coord_t>(x + obj->coords.x1), static_cast<lv_coord_t>(y + obj->coords.y1),
+                        static_cast<lv_coord_t>(x + obj->coords.x2 - 1), static_cast<lv_coord_t>(y + obj->coords.y2 - 1)};
+    lv_area_t obj_clip;
+    if (!area_intersect(coords, clip, obj_clip)) return;
+
+    draw_part(ctx, obj, LV_PART_MAIN, coords, obj_clip);
+    if (lv_obj_check_type(obj, &lv_label_class)) {
+        draw_label(ctx, obj, coords, obj_clip);
+    } else if (lv_obj_check_type(obj, &lv_bar_class)) {
+        draw_bar(ctx, obj, coords, obj_clip);
+    } else if (lv_obj_check_type(obj, &lv_btnmatrix_class)) {
+        draw_btnmatrix(ctx, obj, coords, obj_clip);
+    }
+
+    // Children are clipped to their parent
+    uint32_t count = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < count; i++) {
+        draw_obj(ctx, lv_obj_get_child(obj, static_cast<int32_t>(i)), coords.x1, coords.y1, obj_clip);
+    }
+}
+
+// Merges invalidated areas where the union costs no more than drawing both
+static void join_areas(lv_disp_t* disp) {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (uint16_t i = 0; i < disp->inv_p && !merged; i++) {
+            for (uint16_t j = i + 1; j < disp->inv_p; j++) {
+                const lv_area_t& a = disp->inv_areas[i];
+                const lv_area_t& b = disp->inv_areas[j];
+                if (a.x1 > b.x2 + 1 || b.x1 > a.x2 + 1 || a.y1 > b.y2 + 1 || b.y1 > a.y2 + 1) continue;
+                lv_area_t u = {std::min(a.x1, b.x1), std::min(a.y1, b.y1),
+                               std::max(a.x2, b.x2), std::max(a.y2, b.y2)};
+                if (area_size(u) > area_size(a) + area_size(b)) continue;
+                disp->inv_areas[i] = u;
+                disp->inv_areas[j] = disp->inv_areas[--disp->inv_p];
+                merged = true;
+                break;
+            }
+        }
+    }
+}
+
+// How long a flush may take before the renderer takes its buffer back
+static constexpr auto FLUSH_TIMEOUT = std::chrono::milliseconds(1000);
+
+// Waits until the driver is done with the draw buffer it was last handed.
+// A flush_cb that never calls lv_disp_flush_ready() would otherwise hang
+// the main loop, so after FLUSH_TIMEOUT the buffer is reclaimed
+static void wait_for_flush(lv_disp_draw_buf_t* draw_buf) {
+    if (!draw_buf->flushing) return;
+    auto deadline = std::chrono::steady_clock::now() + FLUSH_TIMEOUT;
+    while (draw_buf->flushing) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            static bool warned = false;
+            if (!warned) {
+                std::cerr << "Warning: flush_cb did not call lv_disp_flush_ready() within "
+                          << FLUSH_TIMEOUT.count() << " ms" << std::endl;
+                warned = true;
+            }
+            draw_buf->flushing = 0;
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+static void flush(lv_disp_drv_t* drv, const lv_area_t& area, lv_color_t* buf, bool last) {
+    lv_disp_draw_buf_t* draw_buf = drv->draw_buf;
+    draw_buf->area = area;
+    draw_buf->flushing = 1;
+    draw_buf->flushing_last = last;
+    drv->flush_cb(drv, &draw_buf->area, buf);
+}
+
+static void swap_buffers(lv_disp_draw_buf_t* draw_buf) {
+    if (draw_buf->buf2) {
+        draw_buf->buf_act = draw_buf->buf_act == draw_buf->buf1 ? draw_buf->buf2 : draw_buf->buf1;
+    }
+}
+
+// Partial mode: each area is drawn in strips as tall as the draw buffer
+// allows, and every strip is flushed on its own. A buffer narrower than the
+// area also splits it into columns
+static void render_strips(lv_disp_t* disp) {
+    lv_disp_drv_t* drv = disp->driver;
+    lv_disp_draw_buf_t* draw_buf = drv->draw_buf;
+    if (draw_buf->size == 0) return;
+
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        const lv_area_t& area = disp->inv_areas[i];
+        lv_coord_t width = std::min<lv_coord_t>(area.x2 - area.x1 + 1,
+                                                static_cast<lv_coord_t>(std::min<uint32_t>(draw_buf->size, 0x7FFF)));
+        lv_coord_t rows = static_cast<lv_coord_t>(draw_buf->size / width);
+
+        for (lv_coord_t y = area.y1; y <= area.y2; y += rows) {
+            for (lv_coord_t x = area.x1; x <= area.x2; x += width) {
+                wait_for_flush(draw_buf);
+
+                DrawCtx ctx;
+                ctx.buf = static_cast<lv_color_t*>(draw_buf->buf_act);
+                ctx.area = {x, y, std::min<lv_coord_t>(area.x2, x + width - 1),
+                            std::min<lv_coord_t>(area.y2, y + rows - 1)};
+                ctx.stride = ctx.area.x2 - ctx.area.x1 + 1;
+                memset(ctx.buf, 0, area_size(ctx.area) * sizeof(lv_color_t));
+
+                draw_obj(ctx, disp->act_scr, 0, 0, ctx.area);
+                flush(drv, ctx.area, ctx.buf,
+                      i + 1 == disp->inv_p && ctx.area.y2 == area.y2 && ctx.area.x2 == area.x2);
+
+                // Render the next strip into the other buffer while this one is sent
+                swap_buffers(draw_buf);
+            }
+        }
+    }
+}
+
+// Direct mode: the buffer is the screen, so areas are drawn in place and
+// flushed with the whole buffer (the driver only looks at the area)
+static void render_direct(lv_disp_t* disp) {
+    lv_disp_drv_t* drv = disp->driver;
+    lv_disp_draw_buf_t* draw_buf = drv->draw_buf;
+    wait_for_flush(draw_buf);
+
+    DrawCtx ctx;
+    ctx.buf = static_cast<lv_color_t*>(draw_buf->buf_act);
+    ctx.area = {0, 0, static_cast<lv_coord_t>(drv->hor_res - 1), static_cast<lv_coord_t>(drv->ver_res - 1)};
+    ctx.stride = drv->hor_res;
+
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        const lv_area_t& area = disp->inv_areas[i];
+        for (lv_coord_t y = area.y1; y <= area.y2; y++) {
+            pixel_fill(&ctx.buf[y * ctx.stride + area.x1].full, 0, area.x2 - area.x1 + 1);
+        }
+        draw_obj(ctx, disp->act_scr, 0, 0, area);
+        wait_for_flush(draw_buf);
+        flush(drv, area, ctx.buf, i + 1 == disp->inv_p);
+    }
+
+    // With two buffers, bring the other one up to date before drawing into it
+    if (draw_buf->buf2) {
+        wait_for_flush(draw_buf);
+        swap_buffers(draw_buf);
+        lv_color_t* next = static_cast<lv_color_t*>(draw_buf->buf_act);
+        for (uint16_t i = 0; i < disp->inv_p; i++) {
+            const lv_area_t& a = disp->inv_areas[i];
+            size_t offset = a.y1 * ctx.stride + a.x1;
+            pixel_copy(&next[offset].full, ctx.stride, &ctx.buf[offset].full, ctx.stride,
+                       a.x2 - a.x1 + 1, a.y2 - a.y1 + 1);
+        }
+    }
+}
+
+// Full refresh: any change redraws the whole screen into a screen-sized
+// buffer, which is flushed in one piece
+static void render_full(lv_disp_t* disp) {
+    lv_disp_drv_t* drv = disp->driver;
+    lv_disp_draw_buf_t* draw_buf = drv->draw_buf;
+    wait_for_flush(draw_buf);
+
+    DrawCtx ctx;
+    ctx.buf = static_cast<lv_color_t*>(draw_buf->buf_act);
+    ctx.area = {0, 0, static_cast<lv_coord_t>(drv->hor_res - 1), static_cast<lv_coord_t>(drv->ver_res - 1)};
+    ctx.stride = drv->hor_res;
+    memset(ctx.buf, 0, area_size(ctx.area) * sizeof(lv_color_t));
+
+    draw_obj(ctx, disp->act_scr, 0, 0, ctx.area);
+    flush(drv, ctx.area, ctx.buf, true);
+
+    // Draw the next frame into the other page while this one is shown
+    swap_buffers(draw_buf);
+}
+
+void render_invalidated(lv_disp_t* disp) {
+    if (!disp || disp->inv_p == 0 || !disp->act_scr) return;
+    lv_disp_drv_t* drv = disp->driver;
+    if (!drv || !drv->draw_buf || !drv->flush_cb) return;
+
+    // Direct and full-refresh drawing need a screen-sized buffer
+    bool screen_sized = drv->draw_buf->size >= static_cast<uint32_t>(drv->hor_res) * drv->ver_res;
+    if (drv->full_refresh && screen_sized) {
+        render_full(disp);
+    } else {
+        join_areas(disp);
+        if (drv->direct_mode && screen_sized) {
+            render_direct(disp);
+        } else {
+            render_strips(disp);
+        }
+    }
+
+    disp->inv_p = 0;
+}
+
+} // namespace host
@@ -0,0 +1,184 @@
+/**
+ * @file shared_framebuffer.cpp
+ * @brief Shared-Memory Screen Transport Implementation for Host Mode
+ */
+
+#include "host/shared_framebuffer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+namespace host {
+
+static_assert(offsetof(SharedFramebufferHeader, seq) == 12, "shared header layout");
+static_assert(offsetof(SharedFramebufferHeader, frame) == 24, "shared header layout");
+static_assert(offsetof(SharedFramebufferHeader, buffer_offset) == 36, "shared header layout");
+static_assert(offsetof(SharedFramebufferHeader, dirty) == SHM_BITMAP_OFFSET, "shared header layout");
+static_assert(sizeof(SharedFramebufferHeader) <= SHM_BUFFER_OFFSET, "shared header layout");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "seqlock must be address-free");
+
+SharedFramebuffer::SharedFramebuffer()
+    : _width(0), _height(0), _size(0), _header(nullptr), _buffers{nullptr, nullptr},
+      _prev_count(0), _prev_full(true) {}
+
+SharedFramebuffer::~SharedFramebuffer() {
+    close();
+}
+
+bool SharedFramebuffer::open(const std::string& name, int width, int height) {
+#ifdef _WIN32
+    (void)name;
+    (void)width;
+    (void)height;
+    std::cerr << "Shared-memory screen transport is not supported on Windows" << std::endl;
+    return false;
+#else
+    close();
+
+    size_t tiles_x = (width + SHM_TILE_SIZE - 1) / SHM_TILE_SIZE;
+    size_t tiles_y = (height + SHM_TILE_SIZE - 1) / SHM_TILE_SIZE;
+    if (tiles_x * tiles_y > SHM_BITMAP_SIZE * 8) {
+        std::cerr << "Screen too large for the shared dirty bitmap" << std::endl;
+        return false;
+    }
+
+    size_t buffer_size = static_cast<size_t>(width) * height * sizeof(uint16_t);
+    size_t size = SHM_BUFFER_OFFSET + 2 * buffer_size;
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to create shared memory " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::cerr << "Failed to size shared memory " << name << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory " << name << ": " << strerror(errno) << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    memset(base, 0, size);
+    _header = new (base) SharedFramebufferHeader();
+    _header->magic = SHM_MAGIC;
+    _header->version = SHM_VERSION;
+    _header->width = static_cast<uint16_t>(width);
+    _header->height = static_cast<uint16_t>(height);
+    _header->seq.store(0, std::memory_order_relaxed);
+    _header->front.store(0, std::memory_order_relaxed);
+    _header->tile_size = SHM_TILE_SIZE;
+    _header->frame = 0;
+    _header->tiles_x = static_cast<uint16_t>(tiles_x);
+    _header->tiles_y = static_cast<uint16_t>(tiles_y);
+    _header->buffer_offset = static_cast<uint32_t>(SHM_BUFFER_OFFSET);
+    _header->buffer_size = static_cast<uint32_t>(buffer_size);
+
+    uint8_t* bytes = static_cast<uint8_t*>(base);
+    _buffers[0] = reinterpret_cast<uint16_t*>(bytes + SHM_BUFFER_OFFSET);
+    _buffers[1] = reinterpret_cast<uint16_t*>(bytes + SHM_BUFFER_OFFSET + buffer_size);
+
+    _name = name;
+    _width = width;
+    _height = height;
+    _size = size;
+    _prev_count = 0;
+    _prev_full = true;
+
+    std::cout << "Publishing screen to shared memory " << name << std::endl;
+    return true;
+#endif
+}
+
+void SharedFramebuffer::close() {
+#ifndef _WIN32
+    if (!_header) return;
+    munmap(_header, _size);
+    shm_unlink(_name.c_str());
+#endif
+    _header = nullptr;
+    _buffers[0] = nullptr;
+    _buffers[1] = nullptr;
+}
+
+void SharedFramebuffer::copy_area(const uint16_t* framebuffer, uint16_t* dst, const lv_area_t& area) {
+    int32_t x1 = std::max<int32_t>(area.x1, 0);
+    int32_t y1 = std::max<int32_t>(area.y1, 0);
+    int32_t x2 = std::min<int32_t>(area.x2, _width - 1);
+    int32_t y2 = std::min<int32_t>(area.y2, _height - 1);
+    if (x1 > x2 || y1 > y2) return;
+
+    size_t row_bytes = static_cast<size_t>(x2 - x1 + 1) * sizeof(uint16_t);
+    for (int32_t y = y1; y <= y2; y++) {
+        memcpy(&dst[y * _width + x1], &framebuffer[y * _width + x1], row_bytes);
+    }
+}
+
+uint64_t SharedFramebuffer::publish(const uint16_t* framebuffer, const lv_area_t* dirty, int count, bool full) {
+    if (!_header) return 0;
+
+    full = full || count > MAX_AREAS;
+
+    // Bring the back buffer up to date: it is missing this frame's changes
+    // and the previous frame's, which only went into the other buffer
+    uint32_t back = 1 - _header->front.load(std::memory_order_relaxed);
+    uint16_t* dst = _buffers[back];
+    if (full || _prev_full) {
+        memcpy(dst, framebuffer, static_cast<size_t>(_width) * _height * sizeof(uint16_t));
+    } else {
+        for (int i = 0; i < _prev_count; i++) copy_area(framebuffer, dst, _prev_dirty[i]);
+        for (int i = 0; i < count; i++) copy_area(framebuffer, dst, dirty[i]);
+    }
+
+    // Flip buffers and describe the change under the seqlock
+    uint32_t seq = _header->seq.load(std::memory_order_relaxed);
+    _header->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    _header->front.store(back, std::memory_order_relaxed);
+    uint64_t frame = ++_header->frame;
+
+    uint8_t* bitmap = _header->dirty;
+    if (full) {
+        memset(bitmap, 0xFF, SHM_BITMAP_SIZE);
+    } else {
+        memset(bitmap, 0, SHM_BITMAP_SIZE);
+        int32_t tiles_x = _header->tiles_x;
+        for (int i = 0; i < count; i++) {
+            int32_t tx1 = std::max<int32_t>(dirty[i].x1, 0) / SHM_TILE_SIZE;
+            int32_t ty1 = std::max<int32_t>(dirty[i].y1, 0) / SHM_TILE_SIZE;
+            int32_t tx2 = std::min<int32_t>(dirty[i].x2, _width - 1) / SHM_TILE_SIZE;
+            int32_t ty2 = std::min<int32_t>(dirty[i].y2, _height - 1) / SHM_TILE_SIZE;
+            for (int32_t ty = ty1; ty <= ty2; ty++) {
+                for (int32_t tx = tx1; tx <= tx2; tx++) {
+                    int32_t bit = ty * tiles_x + tx;
+                    bitmap[bit >> 3] |= static_cast<uint8_t>(1 << (bit & 7));
+                }
+            }
+        }
+    }
+
+    _header->seq.store(seq + 2, std::memory_order_release);
+
+    // Remember what the other buffer is now missing
+    _prev_full = full;
+    _prev_count = full ? 0 : count;
+    for (int i = 0; i < _prev_count; i++) _prev_dirty[i] = dirty[i];
+
+    return frame;
+}
+
+} // namespace host
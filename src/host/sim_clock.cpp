@@ -0,0 +1,162 @@
+/**
+ * @file sim_clock.cpp
+ * @brief Simulation Clock Implementation for Host Mode
+ */
+
+#include "host/sim_clock.hpp"
+#include "host/sim_context.hpp"
+#include <thread>
+
+namespace host {
+
+// Whether the calling thread counts towards SimClock participants
+static thread_local bool is_participant = false;
+
+SimClock& SimClock::instance() {
+    return SimContext::current().clock();
+}
+
+SimClock::SimClock()
+    : _start(std::chrono::steady_clock::now()), _spin_us(0), _virtual(false), _virtual_us(0),
+      _participants(0), _sleeping(0), _halted(false) {}
+
+void SimClock::set_virtual(bool enabled) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _virtual = enabled;
+    _virtual_us = 0;
+}
+
+uint64_t SimClock::now_us() const {
+    if (_virtual) {
+        return _virtual_us.load(std::memory_order_acquire);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - _start;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+void SimClock::sleep_until(uint64_t deadline_us) {
+    if (!_virtual) {
+        // Absolute deadline, so a late wakeup never pushes back the next one
+        auto deadline = _start + std::chrono::microseconds(deadline_us);
+        std::this_thread::sleep_until(deadline - std::chrono::microseconds(_spin_us));
+        spin_until(deadline, nullptr);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (deadline_us <= _virtual_us) {
+        // Already due: still give other threads a chance to run
+        lock.unlock();
+        std::this_thread::yield();
+        return;
+    }
+
+    _deadlines.emplace(deadline_us, Sleeper{is_participant, nullptr, nullptr});
+    if (is_participant) _sleeping++;
+    advance_locked();
+
+    // advance_locked() removes our entry and counts us awake
+    _cv.wait(lock, [&]() { return _virtual_us >= deadline_us; });
+}
+
+void SimClock::sleep_until(uint64_t deadline_us, const std::atomic<bool>& wake) {
+    if (!_virtual) {
+        auto deadline = _start + std::chrono::microseconds(deadline_us);
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait_until(lock, deadline - std::chrono::microseconds(_spin_us),
+                           [&]() { return wake.load(); });
+        }
+        spin_until(deadline, &wake);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (wake || deadline_us <= _virtual_us) return;
+
+    bool removed = false;
+    auto entry = _deadlines.emplace(deadline_us, Sleeper{is_participant, &wake, &removed});
+    if (is_participant) _sleeping++;
+    advance_locked();
+
+    _cv.wait(lock, [&]() { return _virtual_us >= deadline_us || wake; });
+    if (!removed) {
+        // The flag was set without interrupt(): we still count as asleep
+        remove_sleeper_locked(entry);
+    }
+}
+
+void SimClock::spin_until(std::chrono::steady_clock::time_point deadline, const std::atomic<bool>* wake) const {
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (wake && *wake) return;
+        std::this_thread::yield();
+    }
+}
+
+void SimClock::interrupt() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto it = _deadlines.begin(); it != _deadlines.end();) {
+        auto entry = it++;
+        if (entry->second.wake && *entry->second.wake) {
+            remove_sleeper_locked(entry);
+        }
+    }
+    _cv.notify_all();
+}
+
+void SimClock::remove_sleeper_locked(std::multimap<uint64_t, Sleeper>::iterator entry) {
+    if (entry->second.participant) _sleeping--;
+    if (entry->second.removed) *entry->second.removed = true;
+    _deadlines.erase(entry);
+}
+
+void SimClock::advance_locked() {
+    if (_halted || _sleeping < _participants || _deadlines.empty()) return;
+
+    uint64_t next = _deadlines.begin()->first;
+    if (next > _virtual_us) {
+        _virtual_us.store(next, std::memory_order_release);
+    }
+
+    // Count the woken threads as running right away, so a thread that goes
+    // back to sleep before they are scheduled cannot trigger another jump
+    while (!_deadlines.empty() && _deadlines.begin()->first <= next) {
+        remove_sleeper_locked(_deadlines.begin());
+    }
+    _cv.notify_all();
+}
+
+void SimClock::halt() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _halted = true;
+}
+
+void SimClock::reserve() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _participants++;
+}
+
+void SimClock::attach_reserved() {
+    is_participant = true;
+}
+
+void SimClock::attach() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (is_participant) return;
+    _participants++;
+    is_participant = true;
+}
+
+bool SimClock::is_attached() const {
+    return is_participant;
+}
+
+void SimClock::detach() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!is_participant) return;
+    is_participant = false;
+    _participants--;
+    advance_locked();
+}
+
+} // namespace host
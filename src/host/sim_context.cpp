@@ -0,0 +1,76 @@
+/**
+ * @file sim_context.cpp
+ * @brief Simulation Context Implementation for Host Mode
+ */
+
+#include "host/sim_context.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace host {
+
+// Context bound to the calling thread (null = primary)
+static thread_local SimContext* bound_context = nullptr;
+
+SimContext::SimContext() : _scheduler(*this), _abandoned(false) {}
+
+SimContext& SimContext::current() {
+    return bound_context ? *bound_context : primary();
+}
+
+SimContext& SimContext::primary() {
+    static SimContext context;
+    return context;
+}
+
+void SimContext::abandon() {
+    _abandoned = true;
+    _clock.halt();
+}
+
+SimContext::Scope::Scope(SimContext& context) : _previous(bound_context) {
+    bound_context = &context;
+}
+
+SimContext::Scope::~Scope() {
+    bound_context = _previous;
+}
+
+void SimContext::run_parallel(size_t count, size_t workers, const std::function<void(size_t)>& job) {
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers = std::min(workers, count);
+
+    HAL& source = primary().hal();
+    std::atomic<size_t> next{0};
+
+    auto worker = [&]() {
+        for (size_t index = next++; index < count; index = next++) {
+            SimContext* context = new SimContext();
+            context->clock().set_virtual(true);
+            context->hal().configure_from(source);
+            context->scheduler().set_enabled(primary().scheduler().is_enabled());
+            {
+                Scope scope(*context);
+                context->clock().attach();
+                job(index);
+                context->clock().detach();
+            }
+            if (!context->is_abandoned()) {
+                delete context;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; i++) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace host
@@ -0,0 +1,134 @@
+/**
+ * @file task_stats.cpp
+ * @brief Task Instrumentation Implementation for Host Mode
+ */
+
+#include "host/task_stats.hpp"
+#include "host/sim_context.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <ctime>
+#endif
+
+namespace host {
+
+// Every live monitor, in creation order
+static std::mutex registry_mutex;
+static std::vector<TaskMonitor*> registry;
+static uint32_t next_id = 1;  // Guarded by registry_mutex
+
+// Monitor bound to the calling thread, and the thread's CPU time when bound
+static thread_local TaskMonitor* bound_monitor = nullptr;
+static thread_local uint64_t bound_cpu_start = 0;
+
+uint64_t thread_cpu_time_us() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+    uint64_t k = (static_cast<uint64_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+    uint64_t u = (static_cast<uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+    return (k + u) / 10; // 100 ns units
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + static_cast<uint64_t>(ts.tv_nsec) / 1000;
+#endif
+}
+
+TaskMonitor::TaskMonitor(const std::string& name, uint32_t priority)
+    : _id(0), _name(name), _priority(priority), _context(&SimContext::current()), _last_wake_us(0) {
+    std::memset(&_timing, 0, sizeof(_timing));
+    publish();
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    _id = next_id++;
+    registry.push_back(this);
+}
+
+TaskMonitor::~TaskMonitor() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+}
+
+void TaskMonitor::record_wakeup(uint64_t target_us, uint64_t woke_us, uint64_t cpu_us) {
+    uint64_t late = woke_us > target_us ? woke_us - target_us : 0;
+    size_t bucket = 0;
+    while (bucket < LATENESS_BUCKETS - 1 && late > LATENESS_BOUNDS_US[bucket]) {
+        bucket++;
+    }
+
+    _timing.wakeups++;
+    _timing.lateness[bucket]++;
+    _timing.lateness_total_us += late;
+    _timing.lateness_max_us = std::max(_timing.lateness_max_us, late);
+    _timing.cpu_us = cpu_us;
+    publish();
+}
+
+void TaskMonitor::record_period(uint64_t target_us, uint64_t woke_us, uint64_t period_us, uint64_t cpu_us,
+                                bool overran) {
+    if (overran) _timing.overruns++;
+    if (_last_wake_us != 0 && woke_us >= _last_wake_us) {
+        uint64_t actual = woke_us - _last_wake_us;
+        uint64_t jitter = actual > period_us ? actual - period_us : period_us - actual;
+        _timing.periods++;
+        _timing.jitter_total_us += jitter;
+        _timing.jitter_max_us = std::max(_timing.jitter_max_us, jitter);
+        _timing.last_period_us = actual;
+    }
+    _last_wake_us = woke_us;
+    record_wakeup(target_us, woke_us, cpu_us);
+}
+
+void TaskMonitor::record_cpu(uint64_t cpu_us) {
+    _timing.cpu_us = cpu_us;
+    publish();
+}
+
+void TaskMonitor::publish() {
+    _published.store(_timing);
+}
+
+void TaskMonitor::get_stats(TaskStats& stats) const {
+    stats.id = _id;
+    stats.name = _name;
+    stats.priority = _priority;
+    _published.load(stats.timing);
+}
+
+TaskMonitor* TaskMonitor::bound() {
+    return bound_monitor;
+}
+
+uint64_t TaskMonitor::bound_cpu_us() {
+    return thread_cpu_time_us() - bound_cpu_start;
+}
+
+TaskMonitor::Scope::Scope(TaskMonitor& monitor)
+    : _previous(bound_monitor), _previous_cpu_start(bound_cpu_start) {
+    bound_monitor = &monitor;
+    bound_cpu_start = thread_cpu_time_us();
+}
+
+TaskMonitor::Scope::~Scope() {
+    bound_monitor = _previous;
+    bound_cpu_start = _previous_cpu_start;
+}
+
+void TaskMonitor::collect(SimContext& context, std::vector<TaskStats>& out) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    size_t count = 0;
+    for (const TaskMonitor* monitor : registry) {
+        if (monitor->_context != &context) continue;
+        if (count == out.size()) out.emplace_back();
+        monitor->get_stats(out[count++]);
+    }
+    out.resize(count);
+}
+
+} // namespace host
@@ -0,0 +1,347 @@
+/**
+ * @file websocket.cpp
+ * @brief RFC 6455 WebSocket Protocol Implementation for Host Mode
+ */
+
+#include "host/websocket.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <random>
+
+namespace host {
+
+// GUID appended to the client key to derive Sec-WebSocket-Accept (RFC 6455 section 1.3)
+static const char WEBSOCKET_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static std::string base64_encode(const uint8_t* data, size_t len) {
+    std::string result;
+    result.reserve((len + 2) / 3 * 4);
+
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t n = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < len) n |= static_cast<uint32_t>(data[i + 1]) << 8;
+        if (i + 2 < len) n |= static_cast<uint32_t>(data[i + 2]);
+
+        result += base64_chars[(n >> 18) & 0x3F];
+        result += base64_chars[(n >> 12) & 0x3F];
+        result += (i + 1 < len) ? base64_chars[(n >> 6) & 0x3F] : '=';
+        result += (i + 2 < len) ? base64_chars[n & 0x3F] : '=';
+    }
+
+    return result;
+}
+
+static uint32_t rotl32(uint32_t v, int n) {
+    return (v << n) | (v >> (32 - n));
+}
+
+// SHA-1 digest; only used for the handshake accept key
+static void sha1(const std::string& input, uint8_t digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    // Pad to a multiple of 64 bytes with the bit length in the last 8
+    std::string msg = input;
+    uint64_t bit_len = static_cast<uint64_t>(input.size()) * 8;
+    msg += static_cast<char>(0x80);
+    while (msg.size() % 64 != 56) msg += '\0';
+    for (int i = 7; i >= 0; i--) {
+        msg += static_cast<char>((bit_len >> (i * 8)) & 0xFF);
+    }
+
+    for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(&msg[chunk + i * 4]);
+            w[i] = (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = rotl32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t temp = rotl32(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl32(b, 30);
+            b = a;
+            a = temp;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4] = static_cast<uint8_t>(h[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(h[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(h[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(h[i]);
+    }
+}
+
+std::string websocket_handshake_request(const std::string& host, uint16_t port,
+                                        const std::string& path, std::string& key) {
+    std::random_device rd;
+    uint8_t nonce[16];
+    for (uint8_t& byte : nonce) {
+        byte = static_cast<uint8_t>(rd());
+    }
+    key = base64_encode(nonce, sizeof(nonce));
+
+    std::string request;
+    request += "GET " + path + " HTTP/1.1\r\n";
+    request += "Host: " + host + ":" + std::to_string(port) + "\r\n";
+    request += "Upgrade: websocket\r\n";
+    request += "Connection: Upgrade\r\n";
+    request += "Sec-WebSocket-Key: " + key + "\r\n";
+    request += "Sec-WebSocket-Version: 13\r\n";
+    request += "\r\n";
+    return request;
+}
+
+bool websocket_handshake_valid(const std::string& response, const std::string& key) {
+    if (response.compare(0, 12, "HTTP/1.1 101") != 0) return false;
+
+    uint8_t digest[20];
+    sha1(key + WEBSOCKET_GUID, digest);
+    std::string expected = base64_encode(digest, sizeof(digest));
+
+    // Header names are case-insensitive
+    std::string lower = response;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    const std::string name = "\r\nsec-websocket-accept:";
+    size_t pos = lower.find(name);
+    if (pos == std::string::npos) return false;
+
+    size_t start = pos + name.size();
+    while (start < response.size() && (response[start] == ' ' || response[start] == '\t')) start++;
+    size_t end = response.find("\r\n", start);
+    if (end == std::string::npos) return false;
+    while (end > start && (response[end - 1] == ' ' || response[end - 1] == '\t')) end--;
+
+    return response.compare(start, end - start, expected) == 0;
+}
+
+void websocket_mask(uint8_t* data, size_t len, const uint8_t key[4], size_t offset) {
+    // Replicate the key, rotated to the payload offset, across a 64-bit word
+    uint8_t wide[8];
+    for (size_t i = 0; i < 8; i++) {
+        wide[i] = key[(offset + i) & 3];
+    }
+    uint64_t mask;
+    memcpy(&mask, wide, sizeof(mask));
+
+    // memcpy keeps the word loop alignment-safe; compilers turn it into vector XORs
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        word ^= mask;
+        memcpy(data + i, &word, sizeof(word));
+    }
+    for (; i < len; i++) {
+        data[i] ^= wide[i & 7];
+    }
+}
+
+WebSocketParser::WebSocketParser(size_t ring_capacity, size_t max_message)
+    : _max_message(max_message) {
+    size_t size = 64;
+    while (size < ring_capacity) size <<= 1;
+    _mask = size - 1;
+    _ring.reset(new uint8_t[size]);
+    reset();
+}
+
+void WebSocketParser::reset() {
+    _read_pos = 0;
+    _write_pos = 0;
+    _state = State::HEADER;
+    _opcode = 0;
+    _fin = false;
+    _masked = false;
+    memset(_mask_key, 0, sizeof(_mask_key));
+    _remaining = 0;
+    _payload_offset = 0;
+    _message.clear();
+    _message_opcode = WS_OPCODE_TEXT;
+    _in_fragment = false;
+    _control.clear();
+    _close_code = 0;
+    _error_code = 0;
+}
+
+uint8_t* WebSocketParser::write_ptr(size_t& available) {
+    size_t capacity = _mask + 1;
+    size_t index = _write_pos & _mask;
+    available = std::min(capacity - buffered(), capacity - index);
+    return &_ring[index];
+}
+
+void WebSocketParser::commit(size_t len) {
+    _write_pos += len;
+}
+
+size_t WebSocketParser::feed(const uint8_t* data, size_t len) {
+    size_t total = 0;
+    while (total < len) {
+        size_t available;
+        uint8_t* dst = write_ptr(available);
+        if (available == 0) break;
+        size_t chunk = std::min(available, len - total);
+        memcpy(dst, data + total, chunk);
+        commit(chunk);
+        total += chunk;
+    }
+    return total;
+}
+
+void WebSocketParser::consume_into(std::string& out, size_t len) {
+    size_t old_size = out.size();
+    out.resize(old_size + len);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(&out[old_size]);
+
+    // At most two copies: up to the end of the ring, then from its start
+    size_t index = _read_pos & _mask;
+    size_t first = std::min(len, _mask + 1 - index);
+    memcpy(dst, &_ring[index], first);
+    if (first < len) {
+        memcpy(dst + first, &_ring[0], len - first);
+    }
+
+    if (_masked) {
+        websocket_mask(dst, len, _mask_key, static_cast<size_t>(_payload_offset));
+    }
+    _payload_offset += len;
+    _read_pos += len;
+}
+
+WebSocketParser::Result WebSocketParser::fail(uint16_t code) {
+    _error_code = code;
+    return Result::PROTOCOL_ERROR;
+}
+
+WebSocketParser::Result WebSocketParser::next() {
+    while (true) {
+        if (_state == State::HEADER) {
+            if (buffered() < 2) return Result::NEED_MORE;
+
+            uint8_t b0 = peek(0);
+            uint8_t b1 = peek(1);
+            uint8_t len7 = b1 & 0x7F;
+            size_t header_len = 2;
+            if (len7 == 126) header_len += 2;
+            else if (len7 == 127) header_len += 8;
+            if (b1 & 0x80) header_len += 4;
+            if (buffered() < header_len) return Result::NEED_MORE;
+
+            _fin = (b0 & 0x80) != 0;
+            _opcode = b0 & 0x0F;
+            _masked = (b1 & 0x80) != 0;
+
+            // No extensions are negotiated, so RSV bits must be clear
+            if (b0 & 0x70) return fail(WS_CLOSE_PROTOCOL_ERROR);
+
+            size_t pos = 2;
+            uint64_t len = len7;
+            if (len7 == 126) {
+                len = (static_cast<uint64_t>(peek(2)) << 8) | peek(3);
+                pos = 4;
+            } else if (len7 == 127) {
+                len = 0;
+                for (size_t i = 0; i < 8; i++) {
+                    len = (len << 8) | peek(2 + i);
+                }
+                pos = 10;
+            }
+            if (_masked) {
+                for (size_t i = 0; i < 4; i++) {
+                    _mask_key[i] = peek(pos + i);
+                }
+            }
+            _read_pos += header_len;
+
+            if (_opcode & 0x8) {
+                // Control frames: never fragmented, payload <= 125 bytes
+                if (_opcode != WS_OPCODE_CLOSE && _opcode != WS_OPCODE_PING &&
+                    _opcode != WS_OPCODE_PONG) {
+                    return fail(WS_CLOSE_PROTOCOL_ERROR);
+                }
+                if (!_fin || len > 125) return fail(WS_CLOSE_PROTOCOL_ERROR);
+                _control.clear();
+            } else {
+                if (_opcode == WS_OPCODE_CONTINUATION) {
+                    if (!_in_fragment) return fail(WS_CLOSE_PROTOCOL_ERROR);
+                } else if (_opcode == WS_OPCODE_TEXT || _opcode == WS_OPCODE_BINARY) {
+                    if (_in_fragment) return fail(WS_CLOSE_PROTOCOL_ERROR);
+                    _message.clear();
+                    _message_opcode = _opcode;
+                    _in_fragment = true;
+                } else {
+                    return fail(WS_CLOSE_PROTOCOL_ERROR);
+                }
+                if (len > _max_message - _message.size()) return fail(WS_CLOSE_TOO_BIG);
+            }
+
+            _remaining = len;
+            _payload_offset = 0;
+            _state = State::PAYLOAD;
+        }
+
+        // Stream whatever part of the payload has arrived
+        bool control = (_opcode & 0x8) != 0;
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(_remaining, buffered()));
+        if (chunk > 0) {
+            consume_into(control ? _control : _message, chunk);
+            _remaining -= chunk;
+        }
+        if (_remaining > 0) return Result::NEED_MORE;
+
+        _state = State::HEADER;
+
+        if (control) {
+            if (_opcode == WS_OPCODE_PING) return Result::PING;
+            if (_opcode == WS_OPCODE_PONG) return Result::PONG;
+
+            // 1005: no status code present
+            _close_code = 1005;
+            if (_control.size() >= 2) {
+                _close_code = static_cast<uint16_t>(
+                    (static_cast<uint8_t>(_control[0]) << 8) | static_cast<uint8_t>(_control[1]));
+            }
+            return Result::CLOSE;
+        }
+
+        if (_fin) {
+            _in_fragment = false;
+            return Result::MESSAGE;
+        }
+        // Not the final fragment: keep parsing continuation frames
+    }
+}
+
+} // namespace host
@@ -10,11 +10,19 @@
 #include "host/hal.hpp"
 #include "host/ipc.hpp"
 #include "host/display.hpp"
+#include "host/sim_clock.hpp"
+#include "host/sim_context.hpp"
+#include "host/json_writer.hpp"
+#include "host/task_stats.hpp"
 #include "auton/selector.hpp"
 #include <iostream>
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
 
 // Global state
 static std::atomic<bool> running{true};
@@ -79,6 +87,21 @@ __attribute__((weak)) void opcontrol() {
     std::cout << "Operator control ended" << std::endl;
 }
 
+// Starts a competition mode on its own thread, counted by the sim clock and
+// instrumented like a task
+static std::thread* start_mode_thread(void (*mode_fn)(), const char* name) {
+    host::SimContext* context = &host::SimContext::current();
+    context->clock().reserve();
+    return new std::thread([mode_fn, name, context]() {
+        host::SimContext::Scope scope(*context);
+        host::TaskMonitor monitor(name, TASK_PRIORITY_DEFAULT);
+        host::TaskMonitor::Scope bind(monitor);
+        host::SimClock::instance().attach_reserved();
+        mode_fn();
+        host::SimClock::instance().detach();
+    });
+}
+
 // Mode change handler
 void on_mode_change(const std::string& mode) {
     std::cout << "Mode changed to: " << mode << std::endl;
@@ -104,25 +127,24 @@ void on_touch(const host::TouchInput& input) {
 
 // Controller input handler
 void on_controller(const host::ControllerInput& input) {
-    auto& hal = host::HAL::instance();
-    hal.set_controller_analog(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_ANALOG_LEFT_X, input.lx);
-    hal.set_controller_analog(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_ANALOG_LEFT_Y, input.ly);
-    hal.set_controller_analog(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_ANALOG_RIGHT_X, input.rx);
-    hal.set_controller_analog(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_ANALOG_RIGHT_Y, input.ry);
-    
-    // Map button bits to digital values
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_A, (input.buttons & 0x01) != 0);
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_B, (input.buttons & 0x02) != 0);
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_X, (input.buttons & 0x04) != 0);
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_Y, (input.buttons & 0x08) != 0);
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_UP, (input.buttons & 0x10) != 0);
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_DOWN, (input.buttons & 0x20) != 0);
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_LEFT, (input.buttons & 0x40) != 0);
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_RIGHT, (input.buttons & 0x80) != 0);
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_L1, (input.buttons & 0x100) != 0);
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_L2, (input.buttons & 0x200) != 0);
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_R1, (input.buttons & 0x400) != 0);
-    hal.set_controller_digital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_R2, (input.buttons & 0x800) != 0);
+    std::array<int32_t, 4> analog = {input.lx, input.ly, input.rx, input.ry};
+    
+    // Button bits in the order the UI sends them
+    static const pros::controller_digital_e_t bit_buttons[] = {
+        pros::E_CONTROLLER_DIGITAL_A, pros::E_CONTROLLER_DIGITAL_B,
+        pros::E_CONTROLLER_DIGITAL_X, pros::E_CONTROLLER_DIGITAL_Y,
+        pros::E_CONTROLLER_DIGITAL_UP, pros::E_CONTROLLER_DIGITAL_DOWN,
+        pros::E_CONTROLLER_DIGITAL_LEFT, pros::E_CONTROLLER_DIGITAL_RIGHT,
+        pros::E_CONTROLLER_DIGITAL_L1, pros::E_CONTROLLER_DIGITAL_L2,
+        pros::E_CONTROLLER_DIGITAL_R1, pros::E_CONTROLLER_DIGITAL_R2
+    };
+    std::array<bool, 18> digital = {false};
+    for (size_t bit = 0; bit < sizeof(bit_buttons) / sizeof(bit_buttons[0]); bit++) {
+        digital[bit_buttons[bit]] = (input.buttons & (1u << bit)) != 0;
+    }
+    
+    // One update so tasks never see half of a controller packet
+    host::HAL::instance().set_controller_inputs(pros::E_CONTROLLER_MASTER, analog, digital);
 }
 
 // Auto selection handler
@@ -132,6 +154,230 @@ void on_auto_select(const std::string& category, int index) {
     // This would typically be called from the UI to pre-select an auto
 }
 
+// Publish motor, LCD and task telemetry; the IPC layer coalesces to the telemetry rate
+void publish_telemetry(host::IPCClient& ipc) {
+    auto& hal = host::HAL::instance();
+    
+    // One consistent copy of every port per physics step
+    static host::HALSnapshot snapshot;
+    static uint32_t last_version = 0;
+    hal.get_snapshot(snapshot);
+    if (snapshot.version != last_version) {
+        last_version = snapshot.version;
+        for (uint8_t port = 1; port <= 21; port++) {
+            const host::MotorState& state = snapshot.motors[port - 1];
+            if (!state.connected) continue;
+            ipc.send_motor_telemetry(port, state.voltage, state.actual_velocity, state.position);
+        }
+    }
+    
+    std::vector<std::string> lines(8);
+    for (int16_t line = 0; line < 8; line++) {
+        lines[line] = hal.lcd_get_text(line);
+    }
+    ipc.send_lcd_update(lines);
+    
+    // Task counters change every loop; a few snapshots a second are plenty
+    static std::vector<host::TaskStats> tasks;
+    static uint32_t last_tasks_ms = 0;
+    uint32_t now_ms = pros::millis();
+    if (now_ms - last_tasks_ms >= 250) {
+        last_tasks_ms = now_ms;
+        host::TaskMonitor::collect(host::SimContext::current(), tasks);
+        ipc.send_task_stats(now_ms, tasks);
+    }
+}
+
+// End state of a headless routine, shared with its thread so an overrunning
+// routine never writes into a finished caller's stack
+struct HeadlessRun {
+    std::atomic<bool> done{false};
+    host::HALSnapshot final_state;
+    uint64_t end_us = 0;
+    std::unique_ptr<host::TaskMonitor> monitor;
+};
+
+// Runs one routine on the current context's virtual time and writes a JSON
+// summary. Returns true if the routine finished within the time limit.
+static bool run_headless_auton(const auton::AutonRoutine& routine, bool skills, uint32_t timeout_ms,
+                               std::string& summary) {
+    auto& hal = host::HAL::instance();
+    auto& clock = host::SimClock::instance();
+    
+    // Peak current per port, sampled after every physics step
+    std::array<std::atomic<int32_t>, 21> max_current;
+    for (auto& current : max_current) current = 0;
+    hal.set_state_callback([&hal, &max_current]() {
+        for (uint8_t port = 1; port <= 21; port++) {
+            int32_t current = std::abs(hal.get_motor_current(port));
+            if (current > max_current[port - 1]) max_current[port - 1] = current;
+        }
+    });
+    
+    // The routine records its own end state, before physics runs on past it
+    auto run = std::make_shared<HeadlessRun>();
+    uint64_t start_us = clock.now_us();
+    auto wall_start = std::chrono::steady_clock::now();
+    
+    hal.set_robot_mode(host::RobotMode::AUTONOMOUS);
+    hal.start_physics();
+    
+    host::SimContext* context = &host::SimContext::current();
+    run->monitor = std::make_unique<host::TaskMonitor>("autonomous", TASK_PRIORITY_DEFAULT);
+    clock.reserve();
+    std::thread routine_thread([run, &routine, context]() {
+        host::SimContext::Scope scope(*context);
+        host::TaskMonitor::Scope monitor(*run->monitor);
+        auto& clock = context->clock();
+        clock.attach_reserved();
+        routine.func();
+        run->monitor->record_cpu(host::TaskMonitor::bound_cpu_us());
+        run->end_us = clock.now_us();
+        context->hal().get_snapshot(run->final_state);
+        run->done = true;
+        clock.detach();
+    });
+    
+    // Wait on simulated time so the limit is in routine time, not wall time
+    uint64_t deadline_us = start_us + static_cast<uint64_t>(timeout_ms) * 1000;
+    while (!run->done && running && clock.now_us() < deadline_us) {
+        pros::delay(10);
+    }
+    
+    bool completed = run->done;
+    host::HALSnapshot final_state;
+    uint64_t end_us;
+    if (completed) {
+        routine_thread.join();
+        final_state = run->final_state;
+        end_us = run->end_us;
+    } else {
+        // The routine cannot be stopped. A worker context is frozen and
+        // leaked; the primary context keeps running until the caller exits
+        end_us = clock.now_us();
+        hal.get_snapshot(final_state);
+        if (context != &host::SimContext::primary()) {
+            context->abandon();
+        }
+        routine_thread.detach();
+    }
+    if (completed) {
+        hal.stop_physics();
+    }
+    hal.set_state_callback(nullptr);
+    double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+    
+    host::JsonWriter json(summary);
+    json.begin_object()
+        .key("routine").value(routine.name)
+        .key("category").value(skills ? "skills" : "match")
+        .key("completed").value(completed)
+        .key("duration_ms").value((end_us - start_us) / 1000)
+        .key("wall_ms").value(wall_ms)
+        .key("motors").begin_array();
+    for (uint8_t port = 1; port <= 21; port++) {
+        const host::MotorState& motor = final_state.motors[port - 1];
+        if (!motor.connected) continue;
+        json.begin_object()
+            .key("port").value(port)
+            .key("position").value(motor.position)
+            .key("velocity").value(motor.actual_velocity)
+            .key("max_current").value(max_current[port - 1].load())
+            .end_object();
+    }
+    json.end_array().key("tasks").begin_array();
+    std::vector<host::TaskStats> tasks;
+    host::TaskMonitor::collect(*context, tasks);
+    for (const auto& task : tasks) {
+        json.begin_object()
+            .key("name").value(task.name)
+            .key("cpu_ms").value(task.timing.cpu_us / 1000.0)
+            .key("wakeups").value(task.timing.wakeups)
+            .key("late_max_ms").value(task.timing.lateness_max_us / 1000.0)
+            .key("jitter_max_ms").value(task.timing.jitter_max_us / 1000.0)
+            .key("overruns").value(task.timing.overruns)
+            .end_object();
+    }
+    json.end_array().end_object();
+    return completed;
+}
+
+// Runs the named routines headless and prints one JSON summary line per
+// routine in the order given. With one job they run one after another on the
+// primary context, alongside any tasks initialize() started; with more, each
+// gets its own simulation context on a pool of workers. Returns the process
+// exit code: 0 if every routine finished, 1 if one hit the time limit, 2 if
+// a name is unknown or the routines cannot run in parallel.
+static int run_headless_autons(const std::vector<std::string>& names, const std::string& category,
+                               uint32_t timeout_ms, size_t jobs) {
+    auto& selector = auton::Selector::instance();
+    bool skills = category == "skills";
+    const auto& registered = skills ? selector.get_skills_autos() : selector.get_match_autos();
+    
+    std::vector<const auton::AutonRoutine*> routines;
+    for (const auto& name : names) {
+        const auton::AutonRoutine* routine = nullptr;
+        for (const auto& candidate : registered) {
+            if (candidate.name == name) routine = &candidate;
+        }
+        if (!routine) {
+            std::cerr << "No " << category << " routine named \"" << name << "\". Registered:" << std::endl;
+            for (const auto& candidate : registered) {
+                std::cerr << "  " << candidate.name << std::endl;
+            }
+            return 2;
+        }
+        routines.push_back(routine);
+    }
+    
+    std::vector<std::string> summaries(routines.size());
+    std::vector<char> completed(routines.size(), 0);
+    size_t ran = routines.size();
+    auto& primary = host::SimContext::primary();
+    if (jobs == 1 || routines.size() == 1) {
+        // Each routine starts from the motor configuration initialize() left
+        host::SimContext baseline;
+        baseline.hal().configure_from(primary.hal());
+        for (size_t i = 0; i < routines.size(); i++) {
+            if (i > 0) {
+                primary.hal().configure_from(baseline.hal());
+            }
+            completed[i] = run_headless_auton(*routines[i], skills, timeout_ms, summaries[i]);
+            if (!completed[i]) {
+                // The overrunning routine still owns the primary context
+                ran = i + 1;
+                break;
+            }
+        }
+    } else {
+        // Worker contexts start with no tasks, so ones initialize() started
+        // would be missing from every run
+        std::vector<host::TaskStats> tasks;
+        host::TaskMonitor::collect(primary, tasks);
+        if (!tasks.empty()) {
+            std::cerr << "initialize() started " << tasks.size() << " task(s), which parallel runs cannot share;"
+                      << " run with --jobs 1" << std::endl;
+            return 2;
+        }
+        host::SimContext::run_parallel(routines.size(), jobs, [&](size_t index) {
+            completed[index] = run_headless_auton(*routines[index], skills, timeout_ms, summaries[index]);
+        });
+    }
+    
+    int result = 0;
+    for (size_t i = 0; i < ran; i++) {
+        std::cout << summaries[i] << std::endl;
+        if (!completed[i]) {
+            std::cerr << "Routine \"" << routines[i]->name << "\" did not finish within " << timeout_ms << " ms" << std::endl;
+            result = 1;
+        }
+    }
+    for (size_t i = ran; i < routines.size(); i++) {
+        std::cerr << "Routine \"" << routines[i]->name << "\" was not run" << std::endl;
+    }
+    return result;
+}
+
 // Main function
 int main(int argc, char* argv[]) {
     std::cout << "====================================" << std::endl;
@@ -146,6 +392,19 @@ int main(int argc, char* argv[]) {
     // Parse command line arguments
     std::string server_host = "localhost";
     uint16_t server_port = 9000;
+    uint32_t max_fps = 0;
+    uint32_t telemetry_hz = 50;
+    std::string shm_name;
+    std::string display_mode = "partial";
+    double physics_step_ms = 10.0;
+    int physics_substeps = 1;
+    bool sim_time = false;
+    std::vector<std::string> headless_autons;
+    std::string headless_category = "match";
+    uint32_t headless_timeout_ms = 0;
+    size_t headless_jobs = 1;
+    std::string scheduler = "threads";
+    uint32_t spin_us = 0;
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -155,23 +414,144 @@ int main(int argc, char* argv[]) {
         else if (arg == "--port" && i + 1 < argc) {
             server_port = static_cast<uint16_t>(std::stoi(argv[++i]));
         }
+        else if (arg == "--max-fps" && i + 1 < argc) {
+            max_fps = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--shm" && i + 1 < argc) {
+            shm_name = argv[++i];
+        }
+        else if (arg == "--display-mode" && i + 1 < argc) {
+            display_mode = argv[++i];
+        }
+        else if (arg == "--telemetry-hz" && i + 1 < argc) {
+            telemetry_hz = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--physics-step" && i + 1 < argc) {
+            physics_step_ms = std::stod(argv[++i]);
+        }
+        else if (arg == "--physics-substeps" && i + 1 < argc) {
+            physics_substeps = std::stoi(argv[++i]);
+        }
+        else if (arg == "--sim-time") {
+            sim_time = true;
+        }
+        else if (arg == "--run-auton" && i + 1 < argc) {
+            headless_autons.push_back(argv[++i]);
+        }
+        else if (arg == "--category" && i + 1 < argc) {
+            headless_category = argv[++i];
+        }
+        else if (arg == "--timeout" && i + 1 < argc) {
+            headless_timeout_ms = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--jobs" && i + 1 < argc) {
+            headless_jobs = std::stoul(argv[++i]);
+        }
+        else if (arg == "--spin-us" && i + 1 < argc) {
+            spin_us = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--scheduler" && i + 1 < argc) {
+            scheduler = argv[++i];
+        }
         else if (arg == "--help") {
             std::cout << "Usage: " << argv[0] << " [options]" << std::endl;
             std::cout << "Options:" << std::endl;
             std::cout << "  --host <hostname>  WebSocket server host (default: localhost)" << std::endl;
             std::cout << "  --port <port>      WebSocket server port (default: 9000)" << std::endl;
+            std::cout << "  --max-fps <fps>    Maximum screen update rate (default: 1000 / LV_DISP_DEF_REFR_PERIOD)" << std::endl;
+            std::cout << "  --telemetry-hz <hz> Motor/LCD telemetry rate (default: 50)" << std::endl;
+            std::cout << "  --shm <name>       Publish the screen via shared memory (e.g. /vex_screen)" << std::endl;
+            std::cout << "  --display-mode <m> LVGL rendering: partial, direct or full (default: partial)" << std::endl;
+            std::cout << "  --physics-step <ms> Simulated time per physics step (default: 10)" << std::endl;
+            std::cout << "  --physics-substeps <n> Integration substeps per physics step (default: 1)" << std::endl;
+            std::cout << "  --sim-time         Run on virtual time, as fast as the host allows" << std::endl;
+            std::cout << "  --run-auton <name> Run an autonomous routine headless and print a JSON summary (repeatable)" << std::endl;
+            std::cout << "  --category <cat>   Routine category for --run-auton: match or skills (default: match)" << std::endl;
+            std::cout << "  --timeout <ms>     Time limit for --run-auton (default: 15000 match, 60000 skills)" << std::endl;
+            std::cout << "  --jobs <n>         Routines to simulate in parallel, without tasks or screen (default: 1, 0 = all cores)" << std::endl;
+            std::cout << "  --scheduler <kind> Run tasks on threads or as prioritized fibers (default: threads)" << std::endl;
+            std::cout << "  --spin-us <us>     Busy-wait the last <us> of each delay for sub-ms wakeups (default: 0)" << std::endl;
             std::cout << "  --help             Show this help message" << std::endl;
             return 0;
         }
     }
     
+    if (scheduler != "threads" && scheduler != "fibers") {
+        std::cerr << "Unknown scheduler: " << scheduler << " (expected threads or fibers)" << std::endl;
+        return 2;
+    }
+    host::SimContext::primary().scheduler().set_enabled(scheduler == "fibers");
+    host::SimContext::primary().clock().set_spin(spin_us);
+    
+    host::DisplayMode mode;
+    if (display_mode == "partial") {
+        mode = host::DisplayMode::PARTIAL;
+    } else if (display_mode == "direct") {
+        mode = host::DisplayMode::DIRECT;
+    } else if (display_mode == "full") {
+        mode = host::DisplayMode::FULL_REFRESH;
+    } else {
+        std::cerr << "Unknown display mode: " << display_mode << " (expected partial, direct or full)" << std::endl;
+        return 2;
+    }
+    
+    bool headless = !headless_autons.empty();
+    if (headless) {
+        if (headless_category != "match" && headless_category != "skills") {
+            std::cerr << "Unknown category: " << headless_category << " (expected match or skills)" << std::endl;
+            return 2;
+        }
+        if (headless_timeout_ms == 0) {
+            headless_timeout_ms = headless_category == "skills" ? 60000 : 15000;
+        }
+        sim_time = true;
+    }
+    
+    // Select the time source before anything starts sleeping on it
+    if (sim_time) {
+        std::cout << "Running on virtual time" << std::endl;
+        host::SimClock::instance().set_virtual(true);
+    }
+    
     // Initialize HAL
     std::cout << "Initializing HAL..." << std::endl;
     host::HAL::instance().init();
+    host::HAL::instance().set_physics_step(physics_step_ms, physics_substeps);
     
     // Initialize display
     std::cout << "Initializing display..." << std::endl;
-    host::Display::instance().init();
+    host::Display::instance().init(mode);
+    host::Display::instance().set_max_fps(max_fps);
+    if (!shm_name.empty() && !host::Display::instance().enable_shared_memory(shm_name)) {
+        std::cout << "Warning: Falling back to sending the screen over WebSocket." << std::endl;
+    }
+    
+    // Headless: no UI connection, run the routines and exit. initialize()
+    // configures the primary context, which each run then starts from. The
+    // main thread stays attached throughout so tasks initialize() started
+    // never run ahead of the routines on virtual time
+    if (headless) {
+        host::SimClock::instance().attach();
+        initialize();
+        competition_initialize();
+        int result = run_headless_autons(headless_autons, headless_category, headless_timeout_ms, headless_jobs);
+        
+        // Overrunning routines and tasks initialize() started cannot be
+        // stopped or joined; leave before static destruction tears down
+        // state they are still using
+        std::vector<host::TaskStats> tasks;
+        host::TaskMonitor::collect(host::SimContext::primary(), tasks);
+        if (result == 1 || !tasks.empty()) {
+            std::cout.flush();
+            std::fflush(nullptr);
+            std::_Exit(result);
+        }
+        host::SimClock::instance().detach();
+        
+        host::Display::instance().shutdown();
+        host::HAL::instance().shutdown();
+        return result;
+    }
     
     // Setup IPC callbacks
     auto& ipc = host::IPCClient::instance();
@@ -179,6 +559,8 @@ int main(int argc, char* argv[]) {
     ipc.set_controller_callback(on_controller);
     ipc.set_mode_callback(on_mode_change);
     ipc.set_auto_select_callback(on_auto_select);
+    ipc.set_keyframe_callback([]() { host::Display::instance().request_keyframe(); });
+    ipc.set_telemetry_rate(telemetry_hz);
     
     // Try to connect to WebSocket server
     std::cout << "Connecting to WebSocket server at " << server_host << ":" << server_port << "..." << std::endl;
@@ -188,6 +570,9 @@ int main(int argc, char* argv[]) {
         std::cout << "  cd ui && npm start" << std::endl;
     }
     
+    // From here on the main thread paces itself on the sim clock like a task
+    host::SimClock::instance().attach();
+    
     // Run initialization
     std::cout << "\nRunning initialize()..." << std::endl;
     initialize();
@@ -196,6 +581,9 @@ int main(int argc, char* argv[]) {
     std::cout << "Running competition_initialize()..." << std::endl;
     competition_initialize();
     
+    // Physics runs on its own fixed timestep, independent of this loop
+    host::HAL::instance().start_physics();
+    
     // Main loop
     std::cout << "\nEntering main loop (Ctrl+C to exit)..." << std::endl;
     std::cout << "Waiting for mode change from UI..." << std::endl;
@@ -204,15 +592,15 @@ int main(int argc, char* argv[]) {
     std::thread* mode_thread = nullptr;
     
     while (running) {
-        // Update HAL (physics simulation)
-        host::HAL::instance().update();
-        
         // Update display
         host::Display::instance().update();
         
         // Process IPC messages
         ipc.process_messages();
         
+        // Publish telemetry (coalesced latest-value-wins in the IPC layer)
+        publish_telemetry(ipc);
+        
         // Check for mode changes
         host::RobotMode mode = current_mode.load();
         if (mode != last_mode) {
@@ -230,12 +618,12 @@ int main(int argc, char* argv[]) {
                     
                 case host::RobotMode::AUTONOMOUS:
                     if (mode_thread) delete mode_thread;
-                    mode_thread = new std::thread(autonomous);
+                    mode_thread = start_mode_thread(autonomous, "autonomous");
                     break;
                     
                 case host::RobotMode::OPCONTROL:
                     if (mode_thread) delete mode_thread;
-                    mode_thread = new std::thread(opcontrol);
+                    mode_thread = start_mode_thread(opcontrol, "opcontrol");
                     break;
             }
             
@@ -246,6 +634,8 @@ int main(int argc, char* argv[]) {
         pros::delay(10);
     }
     
+    host::SimClock::instance().detach();
+    
     // Cleanup
     std::cout << "\nShutting down..." << std::endl;
     
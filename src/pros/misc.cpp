@@ -4,29 +4,22 @@
  */
 
 #include "pros/misc.hpp"
+#include "pros/rtos.hpp"
 #include "host/hal.hpp"
-#include <chrono>
-#include <thread>
-
-// Static start time for timing functions
-static auto program_start = std::chrono::steady_clock::now();
+#include "host/sim_clock.hpp"
 
 namespace pros {
 
 void delay(uint32_t milliseconds) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+    Task::delay(milliseconds);
 }
 
 uint32_t millis() {
-    auto now = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - program_start);
-    return static_cast<uint32_t>(duration.count());
+    return host::SimClock::instance().now_ms();
 }
 
 uint64_t micros() {
-    auto now = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(now - program_start);
-    return static_cast<uint64_t>(duration.count());
+    return host::SimClock::instance().now_us();
 }
 
 namespace battery {
@@ -4,73 +4,105 @@
  */
 
 #include "pros/rtos.hpp"
+#include "host/sim_clock.hpp"
+#include "host/sim_context.hpp"
+#include "host/fiber_scheduler.hpp"
+#include <algorithm>
 #include <chrono>
 #include <atomic>
 
-// Static start time for timing functions
-static auto program_start = std::chrono::steady_clock::now();
-
 // Task counter
 static std::atomic<uint32_t> task_count{1}; // Main task counts as 1
 
-// Thread-local task pointer
+// Thread-local task pointer (tasks running as fibers are found through
+// their scheduler instead)
 static thread_local pros::Task* current_task = nullptr;
 
+// Sleeps the calling task: switches fibers when called from one, otherwise
+// blocks the thread on the simulation clock
+static void sleep_until(uint64_t deadline_us) {
+    if (host::FiberScheduler* scheduler = host::FiberScheduler::current()) {
+        scheduler->sleep_until(deadline_us);
+    } else {
+        host::SimClock::instance().sleep_until(deadline_us);
+    }
+}
+
 namespace pros {
 
 // Task implementation
 Task::Task(task_fn_t function, void* parameters,
            uint32_t priority, uint16_t /*stack_depth*/, const char* name)
-    : _name(name ? name : ""), _priority(priority),
-      _state(E_TASK_STATE_READY), _running(true),
-      _notification_value(0), _notification_pending(false) {
-    
-    task_count++;
-    
-    _thread = std::thread([this, function, parameters]() {
-        current_task = this;
-        _state = E_TASK_STATE_RUNNING;
-        
-        try {
-            function(parameters);
-        } catch (...) {
-            // Task threw an exception
-        }
-        
-        _state = E_TASK_STATE_DELETED;
-        _running = false;
-        task_count--;
-    });
+    : _context(nullptr), _scheduler(nullptr), _fiber(nullptr), _name(name ? name : ""),
+      _priority(priority), _state(E_TASK_STATE_READY), _running(true),
+      _notification_value(0), _notification_pending(false),
+      _notification_waiting(false), _notified(false), _monitor(_name, priority) {
+    start([function, parameters]() { function(parameters); });
 }
 
 Task::Task(std::function<void()> function,
            uint32_t priority, uint16_t /*stack_depth*/, const char* name)
-    : _name(name ? name : ""), _priority(priority),
-      _state(E_TASK_STATE_READY), _running(true),
-      _notification_value(0), _notification_pending(false) {
-    
+    : _context(nullptr), _scheduler(nullptr), _fiber(nullptr), _name(name ? name : ""),
+      _priority(priority), _state(E_TASK_STATE_READY), _running(true),
+      _notification_value(0), _notification_pending(false),
+      _notification_waiting(false), _notified(false), _monitor(_name, priority) {
+    start(std::move(function));
+}
+
+void Task::start(std::function<void()> body) {
     task_count++;
+    host::SimContext* context = &host::SimContext::current();
+    _context = context;
+
+    if (context->scheduler().is_enabled()) {
+        _scheduler = &context->scheduler();
+        _fiber = _scheduler->create([this, body]() {
+            try {
+                body();
+            } catch (...) {
+                // Task threw an exception
+            }
+            
+            _monitor.record_cpu(host::FiberScheduler::current()->running_cpu_us());
+            if (_running.exchange(false)) task_count--;
+        }, _priority, _name, this);
+        _scheduler->start(_fiber);
+        return;
+    }
+
+    context->clock().reserve();
     
-    _thread = std::thread([this, function]() {
+    _thread = std::thread([this, body, context]() {
+        host::SimContext::Scope scope(*context);
+        host::SimClock::instance().attach_reserved();
+        host::TaskMonitor::Scope monitor(_monitor);
         current_task = this;
         _state = E_TASK_STATE_RUNNING;
         
         try {
-            function();
+            body();
         } catch (...) {
             // Task threw an exception
         }
         
+        _monitor.record_cpu(host::TaskMonitor::bound_cpu_us());
         _state = E_TASK_STATE_DELETED;
         _running = false;
         task_count--;
+        host::SimClock::instance().detach();
     });
 }
 
 Task::~Task() {
+    if (_fiber) {
+        _scheduler->join(_fiber);
+        _scheduler->release(_fiber);
+        return;
+    }
     if (_thread.joinable()) {
         _running = false;
         _cv.notify_all();
+        host::SimClock::BlockingScope blocking;
         _thread.join();
     }
 }
@@ -84,19 +116,29 @@ uint32_t Task::get_priority() {
 }
 
 task_state_e_t Task::get_state() {
-    return _state;
+    if (!_fiber) return _state;
+
+    switch (_scheduler->state(_fiber)) {
+        case host::FiberState::RUNNING:   return E_TASK_STATE_RUNNING;
+        case host::FiberState::READY:     return E_TASK_STATE_READY;
+        case host::FiberState::SLEEPING:
+        case host::FiberState::BLOCKED:   return E_TASK_STATE_BLOCKED;
+        case host::FiberState::SUSPENDED: return E_TASK_STATE_SUSPENDED;
+        case host::FiberState::FINISHED:  return E_TASK_STATE_DELETED;
+    }
+    return E_TASK_STATE_INVALID;
 }
 
 uint32_t Task::notify() {
-    std::lock_guard<std::mutex> lock(_mutex);
+    std::unique_lock<std::mutex> lock(_mutex);
     _notification_pending = true;
     _notification_value++;
-    _cv.notify_one();
+    wake_waiter(lock);
     return 1;
 }
 
 uint32_t Task::notify_ext(uint32_t value, notify_action_e_t action) {
-    std::lock_guard<std::mutex> lock(_mutex);
+    std::unique_lock<std::mutex> lock(_mutex);
     uint32_t prev = _notification_value;
     
     switch (action) {
@@ -119,7 +161,7 @@ uint32_t Task::notify_ext(uint32_t value, notify_action_e_t action) {
     }
     
     _notification_pending = true;
-    _cv.notify_one();
+    wake_waiter(lock);
     return prev;
 }
 
@@ -131,17 +173,86 @@ bool Task::notify_clear() {
     return was_pending;
 }
 
+uint32_t Task::notify_take(bool clear_on_exit, uint32_t timeout) {
+    Task* task = current();
+    return task ? task->take_notification(clear_on_exit, timeout) : 0;
+}
+
+uint32_t Task::take_notification(bool clear_on_exit, uint32_t timeout) {
+    host::SimClock& clock = _context->clock();
+    bool forever = timeout == TIMEOUT_MAX;
+    uint64_t deadline = clock.now_us() + static_cast<uint64_t>(timeout) * 1000;
+    
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_notification_value == 0) {
+        if (!forever && clock.now_us() >= deadline) return 0;
+        _notified = false;
+        
+        if (_fiber) {
+            lock.unlock();
+            _scheduler->block(forever ? 0 : deadline);
+            lock.lock();
+        } else if (forever && !clock.is_virtual()) {
+            _cv.wait(lock, [this]() { return _notification_value != 0; });
+        } else {
+            // Sleep on the clock so virtual time can reach the deadline;
+            // notify() cuts the sleep short. Waits without a deadline sleep
+            // a tick at a time as a participant, so virtual time cannot run
+            // ahead between the notify and our wakeup
+            uint64_t until = deadline;
+            if (forever) until = clock.now_us() + 1000;
+            _notification_waiting = true;
+            lock.unlock();
+            clock.sleep_until(until, _notified);
+            lock.lock();
+            _notification_waiting = false;
+        }
+    }
+    
+    uint32_t value = _notification_value;
+    _notification_value = clear_on_exit ? 0 : value - 1;
+    _notification_pending = false;
+    return value;
+}
+
+void Task::wake_waiter(std::unique_lock<std::mutex>& lock) {
+    _notified = true;
+    _cv.notify_one();
+    bool sleeping = _notification_waiting;
+    
+    // A woken fiber that outranks the caller runs at once on this thread
+    // and retakes _mutex on its way out of block(), so release it first
+    lock.unlock();
+    if (_fiber) {
+        _scheduler->wake(_fiber);
+    } else if (sleeping) {
+        _context->clock().interrupt();
+    }
+}
+
 void Task::set_priority(uint32_t priority) {
     _priority = priority;
+    _monitor.set_priority(priority);
+    if (_fiber) {
+        _scheduler->set_priority(_fiber, priority);
+    }
     // Note: std::thread doesn't support priority changes
 }
 
 void Task::suspend() {
+    if (_fiber) {
+        _scheduler->suspend(_fiber);
+        return;
+    }
     std::lock_guard<std::mutex> lock(_mutex);
     _state = E_TASK_STATE_SUSPENDED;
 }
 
 void Task::resume() {
+    if (_fiber) {
+        _scheduler->resume(_fiber);
+        return;
+    }
     std::lock_guard<std::mutex> lock(_mutex);
     if (_state == E_TASK_STATE_SUSPENDED) {
         _state = E_TASK_STATE_READY;
@@ -150,82 +261,212 @@ void Task::resume() {
 }
 
 void Task::remove() {
+    if (_fiber) {
+        if (_running.exchange(false)) task_count--;
+        _scheduler->remove(_fiber);  // Does not return when removing itself
+        return;
+    }
     _running = false;
     _state = E_TASK_STATE_DELETED;
     _cv.notify_all();
 }
 
 void Task::join() {
+    if (_fiber) {
+        _scheduler->join(_fiber);
+        return;
+    }
     if (_thread.joinable()) {
+        host::SimClock::BlockingScope blocking;
         _thread.join();
     }
 }
 
 Task* Task::current() {
+    if (host::FiberScheduler* scheduler = host::FiberScheduler::current()) {
+        return static_cast<Task*>(scheduler->running()->owner);
+    }
     return current_task;
 }
 
 void Task::delay(uint32_t milliseconds) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+    delay_us(static_cast<uint64_t>(milliseconds) * 1000);
 }
 
 void Task::delay_until(uint32_t* prev_time, uint32_t delta) {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - program_start).count();
-    
     uint32_t target = *prev_time + delta;
-    if (target > elapsed) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(target - elapsed));
+    wait_for_period(static_cast<uint64_t>(target) * 1000, static_cast<uint64_t>(delta) * 1000);
+    *prev_time = target;
+}
+
+void Task::delay_us(uint64_t microseconds) {
+    uint64_t target_us = host::SimClock::instance().now_us() + microseconds;
+    sleep_until(target_us);
+    record_wakeup(target_us, 0, false);
+}
+
+void Task::delay_until_us(uint64_t* prev_time_us, uint64_t delta_us) {
+    uint64_t target_us = *prev_time_us + delta_us;
+    wait_for_period(target_us, delta_us);
+    *prev_time_us = target_us;
+}
+
+void Task::wait_for_period(uint64_t target_us, uint64_t period_us) {
+    // Deadlines are absolute, so oversleeping one period shortens the next
+    // instead of accumulating drift; a missed deadline returns at once. A
+    // loop that calls in exactly on its deadline is on time, not overrun
+    bool overran = target_us < host::SimClock::instance().now_us();
+    if (!overran) {
+        sleep_until(target_us);
+    }
+    record_wakeup(target_us, period_us, overran);
+}
+
+void Task::record_wakeup(uint64_t target_us, uint64_t period_us, bool overran) {
+    host::TaskMonitor* monitor;
+    uint64_t cpu_us;
+    if (host::FiberScheduler* scheduler = host::FiberScheduler::current()) {
+        monitor = &static_cast<Task*>(scheduler->running()->owner)->_monitor;
+        cpu_us = scheduler->running_cpu_us();
+    } else if ((monitor = host::TaskMonitor::bound())) {
+        cpu_us = host::TaskMonitor::bound_cpu_us();
+    } else {
+        return;  // Not a task (such as the main loop)
     }
     
-    *prev_time = target;
+    uint64_t woke_us = host::SimClock::instance().now_us();
+    if (period_us) {
+        monitor->record_period(target_us, woke_us, period_us, cpu_us, overran);
+    } else {
+        monitor->record_wakeup(target_us, woke_us, cpu_us);
+    }
 }
 
 uint32_t Task::get_count() {
     return task_count;
 }
 
+void Task::get_stats(host::TaskStats& stats) {
+    _monitor.get_stats(stats);
+}
+
 // Mutex implementation
-Mutex::Mutex() {}
+
+// A task blocked in Mutex::take(). It lives on the waiter's stack and
+// leaves the wait list before take() returns.
+struct Mutex::Waiter {
+    host::FiberScheduler* scheduler;   // Null for a thread
+    host::Fiber* fiber;
+    host::SimClock* clock;
+    uint32_t priority;
+    std::atomic<bool> granted{false};  // give() handed the mutex over
+    bool sleeping = false;             // Thread in a timed clock sleep
+};
+
+Mutex::Mutex() : _locked(false) {}
 
 Mutex::~Mutex() {}
 
 bool Mutex::take(uint32_t timeout) {
-    if (timeout == 0) {
-        _mutex.lock();
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_locked) {
+        _locked = true;
         return true;
-    } else {
-        return _mutex.try_lock_for(std::chrono::milliseconds(timeout));
     }
+    
+    host::SimClock& clock = host::SimClock::instance();
+    bool forever = timeout == 0;
+    uint64_t deadline = clock.now_us() + static_cast<uint64_t>(timeout) * 1000;
+    
+    Waiter waiter;
+    waiter.scheduler = host::FiberScheduler::current();
+    waiter.fiber = waiter.scheduler ? waiter.scheduler->running() : nullptr;
+    waiter.clock = &clock;
+    Task* task = Task::current();
+    waiter.priority = task ? task->get_priority() : TASK_PRIORITY_DEFAULT;
+    _waiters.push_back(&waiter);
+    
+    // The owner may be a fiber on this very thread, so never block the
+    // thread itself: fibers switch away and threads sleep like a task
+    while (!waiter.granted) {
+        if (!forever && clock.now_us() >= deadline) {
+            _waiters.erase(std::find(_waiters.begin(), _waiters.end(), &waiter));
+            return false;
+        }
+        
+        if (waiter.fiber) {
+            lock.unlock();
+            waiter.scheduler->block(forever ? 0 : deadline);
+            lock.lock();
+        } else if (forever && !clock.is_virtual()) {
+            _cv.wait(lock, [&waiter]() { return waiter.granted.load(); });
+        } else {
+            // On virtual time, sleep a tick at a time as a participant, so
+            // time cannot run ahead between the grant and our wakeup
+            uint64_t until = deadline;
+            if (clock.is_virtual()) {
+                until = clock.now_us() + 1000;
+                if (!forever) until = std::min(until, deadline);
+            }
+            waiter.sleeping = true;
+            lock.unlock();
+            clock.sleep_until(until, waiter.granted);
+            lock.lock();
+            waiter.sleeping = false;
+        }
+    }
+    return true;
 }
 
 bool Mutex::give() {
-    _mutex.unlock();
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_waiters.empty()) {
+        _locked = false;
+        return true;
+    }
+    
+    // Highest priority first, then first come; the mutex stays locked
+    auto next = _waiters.begin();
+    for (auto it = _waiters.begin(); it != _waiters.end(); ++it) {
+        if ((*it)->priority > (*next)->priority) next = it;
+    }
+    Waiter* waiter = *next;
+    _waiters.erase(next);
+    waiter->granted = true;
+    
+    // The waiter may return as soon as it sees the grant, so copy what the
+    // wake needs first, and wake after unlocking: a woken fiber that
+    // outranks us runs at once on this thread
+    host::FiberScheduler* scheduler = waiter->scheduler;
+    host::Fiber* fiber = waiter->fiber;
+    host::SimClock* clock = waiter->sleeping ? waiter->clock : nullptr;
+    lock.unlock();
+    
+    if (fiber) {
+        scheduler->wake(fiber);
+    } else if (clock) {
+        clock->interrupt();
+    } else {
+        _cv.notify_all();
+    }
     return true;
 }
 
 void Mutex::lock() {
-    _mutex.lock();
+    take(0);
 }
 
 void Mutex::unlock() {
-    _mutex.unlock();
+    give();
 }
 
 // Clock implementation
 uint32_t Clock::now() {
-    auto now_time = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now_time - program_start);
-    return static_cast<uint32_t>(duration.count());
+    return host::SimClock::instance().now_ms();
 }
 
 uint64_t Clock::now_us() {
-    auto now_time = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
-        now_time - program_start);
-    return static_cast<uint64_t>(duration.count());
+    return host::SimClock::instance().now_us();
 }
 
 } // namespace pros
@@ -241,4 +482,12 @@ void task_delay_until(uint32_t* prev_time, uint32_t delta) {
     pros::Task::delay_until(prev_time, delta);
 }
 
+void task_delay_until_us(uint64_t* prev_time_us, uint64_t delta_us) {
+    pros::Task::delay_until_us(prev_time_us, delta_us);
+}
+
+uint32_t task_notify_take(bool clear_on_exit, uint32_t timeout) {
+    return pros::Task::notify_take(clear_on_exit, timeout);
+}
+
 } // extern "C"
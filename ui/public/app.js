@@ -50,6 +50,7 @@ function initWebSocket() {
     
     try {
         ws = new WebSocket(wsUrl);
+        ws.binaryType = 'arraybuffer';
         
         ws.onopen = () => {
             connected = true;
@@ -71,6 +72,11 @@ function initWebSocket() {
         };
         
         ws.onmessage = (event) => {
+            if (event.data instanceof ArrayBuffer) {
+                handleBinaryMessage(event.data);
+                return;
+            }
+            
             try {
                 const message = JSON.parse(event.data);
                 handleMessage(message);
@@ -116,10 +122,6 @@ function handleMessage(message) {
             }
             break;
             
-        case 'screen':
-            updateScreen(message);
-            break;
-            
         case 'motor':
             updateMotor(message);
             break;
@@ -139,11 +141,50 @@ function handleMessage(message) {
         case 'mode':
             setModeUI(message.value);
             break;
+            
+        case 'tasks':
+            updateTasks(message);
+            break;
+    }
+}
+
+// Binary frame constants (must match include/host/ipc.hpp)
+const SCREEN_FRAME_MAGIC = 0x53;
+const SCREEN_HEADER_SIZE = 20;
+const SCREEN_ENCODING_RAW = 0;
+const SCREEN_ENCODING_DELTA = 1;
+const SCREEN_WIDTH = 480;
+const SCREEN_HEIGHT = 272;
+
+// RGB565 -> RGBA8888 lookup (little-endian 32-bit: 0xAABBGGRR)
+const RGB565_TO_RGBA = new Uint32Array(65536);
+for (let p = 0; p < 65536; p++) {
+    const r = ((p >> 11) & 0x1F) << 3;
+    const g = ((p >> 5) & 0x3F) << 2;
+    const b = (p & 0x1F) << 3;
+    RGB565_TO_RGBA[p] = (0xFF000000 | (b << 16) | (g << 8) | r) >>> 0;
+}
+
+// Handle incoming binary frames (one or more screen records back to back)
+function handleBinaryMessage(buffer) {
+    const view = new DataView(buffer);
+    let offset = 0;
+    
+    while (offset + SCREEN_HEADER_SIZE <= buffer.byteLength) {
+        if (view.getUint8(offset) !== SCREEN_FRAME_MAGIC) return;
+        
+        const length = view.getUint32(offset + 16, true);
+        if (offset + SCREEN_HEADER_SIZE + length > buffer.byteLength) return;
+        
+        updateScreen(buffer, view, offset);
+        offset += SCREEN_HEADER_SIZE + length;
     }
 }
 
 // Brain screen
 let screenCtx = null;
+let screenImage = null;   // Persistent copy of the screen; deltas apply on top
+let screenPixels = null;  // 32-bit view of screenImage
 
 function initBrainScreen() {
     const canvas = document.getElementById('brain-screen');
@@ -152,6 +193,9 @@ function initBrainScreen() {
     // Fill with black initially
     screenCtx.fillStyle = '#000';
     screenCtx.fillRect(0, 0, 480, 272);
+    screenImage = screenCtx.createImageData(SCREEN_WIDTH, SCREEN_HEIGHT);
+    screenPixels = new Uint32Array(screenImage.data.buffer);
+    screenPixels.fill(RGB565_TO_RGBA[0]);
     
     // Touch handling
     canvas.addEventListener('mousedown', (e) => handleTouch(e, true));
@@ -203,35 +247,60 @@ function sendLCDButton(button, pressed) {
     send({ type: 'lcd_button', button: btnValue, pressed });
 }
 
-function updateScreen(data) {
+function updateScreen(buffer, view, offset) {
     if (!screenCtx) return;
     
-    // Decode base64 data
-    const binaryString = atob(data.data);
-    const bytes = new Uint8Array(binaryString.length);
-    for (let i = 0; i < binaryString.length; i++) {
-        bytes[i] = binaryString.charCodeAt(i);
+    const encoding = view.getUint8(offset + 1);
+    const x1 = view.getInt16(offset + 8, true);
+    const y1 = view.getInt16(offset + 10, true);
+    const x2 = view.getInt16(offset + 12, true);
+    const y2 = view.getInt16(offset + 14, true);
+    const length = view.getUint32(offset + 16, true);
+    
+    const width = x2 - x1 + 1;
+    const height = y2 - y1 + 1;
+    if (width <= 0 || height <= 0 || x1 < 0 || y1 < 0 ||
+        x2 >= SCREEN_WIDTH || y2 >= SCREEN_HEIGHT) return;
+    
+    // Payload words are little-endian RGB565 (or span headers for deltas)
+    const words = new Uint16Array(buffer, offset + SCREEN_HEADER_SIZE, length >> 1);
+    
+    if (encoding === SCREEN_ENCODING_RAW) {
+        if (words.length < width * height) return;
+        for (let y = 0, i = 0; y < height; y++) {
+            let dst = (y1 + y) * SCREEN_WIDTH + x1;
+            for (let x = 0; x < width; x++, i++) {
+                screenPixels[dst++] = RGB565_TO_RGBA[words[i]];
+            }
+        }
+    } else if (encoding === SCREEN_ENCODING_DELTA) {
+        applyDelta(words, x1, y1, width, height);
+    } else {
+        return;
     }
     
-    // Create image data
-    const width = data.x2 - data.x1 + 1;
-    const height = data.y2 - data.y1 + 1;
-    const imageData = screenCtx.createImageData(width, height);
-    
-    // Convert RGB565 to RGBA
-    for (let i = 0, j = 0; i < bytes.length; i += 2, j += 4) {
-        const pixel = bytes[i] | (bytes[i + 1] << 8);
-        const r = ((pixel >> 11) & 0x1F) << 3;
-        const g = ((pixel >> 5) & 0x3F) << 2;
-        const b = (pixel & 0x1F) << 3;
+    screenCtx.putImageData(screenImage, 0, 0, x1, y1, width, height);
+}
+
+// Applies DELTA_SPANS words ([skip][count][pixels...]) to an area
+function applyDelta(words, x1, y1, width, height) {
+    const total = width * height;
+    let pos = 0;
+    let i = 0;
+    
+    while (i + 1 < words.length) {
+        pos += words[i];
+        const count = words[i + 1];
+        i += 2;
+        
+        if (pos + count > total || i + count > words.length) return;
         
-        imageData.data[j] = r;
-        imageData.data[j + 1] = g;
-        imageData.data[j + 2] = b;
-        imageData.data[j + 3] = 255;
+        for (let n = 0; n < count; n++, pos++) {
+            const x = x1 + (pos % width);
+            const y = y1 + ((pos / width) | 0);
+            screenPixels[y * SCREEN_WIDTH + x] = RGB565_TO_RGBA[words[i++]];
+        }
     }
-    
-    screenCtx.putImageData(imageData, data.x1, data.y1);
 }
 
 function updateLCD(data) {
@@ -554,6 +623,59 @@ function updateMotor(data) {
     barFill.style.backgroundColor = data.voltage >= 0 ? '#4caf50' : '#f44336';
 }
 
+// Task statistics
+let lastTaskSample = null;  // Previous snapshot, for CPU percentages (keyed by task id)
+
+function formatUs(us) {
+    return us >= 1000 ? `${(us / 1000).toFixed(1)}ms` : `${Math.round(us)}µs`;
+}
+
+function updateTasks(data) {
+    const rows = document.getElementById('task-rows');
+    if (!rows) return;
+    
+    const previous = lastTaskSample;
+    lastTaskSample = { wall: data.wall_us, cpu: new Map() };
+    rows.innerHTML = '';
+    
+    data.tasks.forEach((task) => {
+        lastTaskSample.cpu.set(task.id, task.cpu_us);
+        
+        // Share of one host core since the previous snapshot. CPU time is
+        // real, so it is divided by wall time: with --sim-time the virtual
+        // clock runs far ahead and would make every task look idle
+        let cpu = '--';
+        if (previous && previous.cpu.has(task.id) && data.wall_us > previous.wall) {
+            const percent = (task.cpu_us - previous.cpu.get(task.id)) * 100 / (data.wall_us - previous.wall);
+            cpu = `${Math.max(0, percent).toFixed(1)}%`;
+        }
+        
+        const lateAvg = task.wakeups ? task.late_total_us / task.wakeups : 0;
+        const jitterAvg = task.periods ? task.jitter_total_us / task.periods : 0;
+        const peak = Math.max(1, ...task.lateness);
+        const hist = task.lateness.map((count, i) => {
+            const label = i < data.bounds_us.length ? `≤${formatUs(data.bounds_us[i])}` : `>${formatUs(data.bounds_us[i - 1])}`;
+            const height = count ? Math.max(2, Math.round(count / peak * 18)) : 0;
+            return `<span style="height: ${height}px" title="${label}: ${count}"></span>`;
+        }).join('');
+        
+        const row = document.createElement('tr');
+        row.innerHTML = `
+            <td></td>
+            <td>${task.priority}</td>
+            <td>${cpu}</td>
+            <td>${task.wakeups}</td>
+            <td class="${task.late_max_us > 1000 ? 'late' : ''}">${formatUs(lateAvg)} / ${formatUs(task.late_max_us)}</td>
+            <td><div class="lateness-hist">${hist}</div></td>
+            <td>${task.periods ? formatUs(task.period_us) : '--'}</td>
+            <td class="${task.jitter_max_us > 1000 ? 'late' : ''}">${task.periods ? `${formatUs(jitterAvg)} / ${formatUs(task.jitter_max_us)}` : '--'}</td>
+            <td class="${task.overruns ? 'late' : ''}">${task.overruns}</td>
+        `;
+        row.firstElementChild.textContent = task.name || '(unnamed)';  // Names come from user code
+        rows.appendChild(row);
+    });
+}
+
 // Console logging
 function log(level, message) {
     const console = document.getElementById('console');
@@ -6,6 +6,7 @@
 const express = require('express');
 const WebSocket = require('ws');
 const path = require('path');
+const fs = require('fs');
 
 const HTTP_PORT = process.env.HTTP_PORT || 3000;
 const WS_PORT = process.env.WS_PORT || 9000;
@@ -54,9 +55,20 @@ wss.on('connection', (ws, req) => {
         
         // Send current host status
         ws.send(JSON.stringify({ type: 'host_status', connected: hostClient !== null }));
+        
+        // Screen updates are deltas; ask the host for a full frame for the new viewer
+        sendToHost({ type: 'keyframe' });
     }
     
-    ws.on('message', (data) => {
+    ws.on('message', (data, isBinary) => {
+        if (isBinary) {
+            // Binary frames carry screen data from the host; pass them through untouched
+            if (clientType === 'host') {
+                broadcastBinaryToUI(data);
+            }
+            return;
+        }
+        
         try {
             const message = JSON.parse(data.toString());
             handleMessage(ws, clientType, message);
@@ -68,6 +80,7 @@ wss.on('connection', (ws, req) => {
     ws.on('close', () => {
         if (clientType === 'host') {
             hostClient = null;
+            closeSharedScreen();  // A restarted host creates a new segment
             console.log('Host application disconnected');
             broadcastToUI({ type: 'host_status', connected: false });
         } else {
@@ -93,6 +106,144 @@ function broadcastToUI(message) {
     });
 }
 
+// Broadcast a binary frame to all UI clients without re-encoding
+function broadcastBinaryToUI(data) {
+    uiClients.forEach((client) => {
+        if (client.readyState === WebSocket.OPEN) {
+            client.send(data, { binary: true });
+        }
+    });
+}
+
+// Shared-memory screen transport (host started with --shm)
+// Layout is documented in include/host/shared_framebuffer.hpp. Node cannot
+// map memory without a native addon, so the segment is used as a file-backed
+// side channel: the changed rows are read from /dev/shm (Linux only) into a
+// fresh buffer, which saves the host->server socket hop but not the copy.
+const SHM_MAGIC = 0x42465856;
+const SCREEN_FRAME_MAGIC = 0x53;
+const SCREEN_HEADER_SIZE = 20;
+
+// Notifications are coalesced and can lag; the frame counter is also polled
+// so the last frame of a burst always reaches the viewers
+const SHM_POLL_MS = 100;
+let shm = null;
+
+function closeSharedScreen() {
+    if (shm) fs.closeSync(shm.fd);
+    shm = null;
+}
+
+function openSharedScreen(name) {
+    if (shm && shm.name === name) return shm;
+    closeSharedScreen();
+    
+    if (process.platform !== 'linux') {
+        throw new Error('reading shared-memory screens needs /dev/shm (Linux); start the host without --shm');
+    }
+    const fd = fs.openSync(path.join('/dev/shm', name), 'r');
+    const header = Buffer.alloc(128);
+    fs.readSync(fd, header, 0, header.length, 0);
+    if (header.readUInt32LE(0) !== SHM_MAGIC) {
+        fs.closeSync(fd);
+        throw new Error(`${name} is not a host screen segment`);
+    }
+    shm = {
+        name,
+        fd,
+        header,
+        width: header.readUInt16LE(8),
+        height: header.readUInt16LE(10),
+        tileSize: header.readUInt32LE(20),
+        tilesX: header.readUInt16LE(32),
+        tilesY: header.readUInt16LE(34),
+        bufferOffset: header.readUInt32LE(36),
+        bufferSize: header.readUInt32LE(40),
+        lastFrame: 0n
+    };
+    return shm;
+}
+
+setInterval(() => {
+    if (!shm || uiClients.size === 0) return;
+    fs.readSync(shm.fd, shm.header, 0, 32, 0);
+    if (shm.header.readBigUInt64LE(24) !== shm.lastFrame) {
+        forwardSharedScreen({ name: shm.name, keyframe: false });
+    }
+}, SHM_POLL_MS);
+
+// Read the rows touched by the latest frame and forward them as a raw screen record
+function forwardSharedScreen(message) {
+    if (uiClients.size === 0) return;
+    
+    let s;
+    try {
+        s = openSharedScreen(message.name);
+    } catch (e) {
+        console.error('Cannot open shared screen:', e.message);
+        return;
+    }
+    
+    for (let attempt = 0; attempt < 3; attempt++) {
+        fs.readSync(s.fd, s.header, 0, s.header.length, 0);
+        const seq = s.header.readUInt32LE(12);
+        if (seq & 1) continue;  // Writer is mid-update
+        
+        const front = s.header.readUInt32LE(16);
+        const frame = s.header.readBigUInt64LE(24);
+        const full = message.keyframe || frame !== s.lastFrame + 1n;
+        
+        // Row range covered by dirty tiles
+        let y1 = 0;
+        let y2 = s.height - 1;
+        if (!full) {
+            let first = -1;
+            let last = -1;
+            for (let ty = 0; ty < s.tilesY; ty++) {
+                for (let tx = 0; tx < s.tilesX; tx++) {
+                    const bit = ty * s.tilesX + tx;
+                    if (s.header[64 + (bit >> 3)] & (1 << (bit & 7))) {
+                        if (first < 0) first = ty;
+                        last = ty;
+                        break;
+                    }
+                }
+            }
+            if (first < 0) {
+                s.lastFrame = frame;
+                return;
+            }
+            y1 = first * s.tileSize;
+            y2 = Math.min((last + 1) * s.tileSize, s.height) - 1;
+        }
+        
+        const rowBytes = s.width * 2;
+        const payloadLength = (y2 - y1 + 1) * rowBytes;
+        const record = Buffer.alloc(SCREEN_HEADER_SIZE + payloadLength);
+        fs.readSync(s.fd, record, SCREEN_HEADER_SIZE, payloadLength,
+                    s.bufferOffset + front * s.bufferSize + y1 * rowBytes);
+        
+        // Discard the read if the writer flipped buffers under us
+        const check = Buffer.alloc(4);
+        fs.readSync(s.fd, check, 0, 4, 12);
+        if (check.readUInt32LE(0) !== seq) continue;
+        
+        record[0] = SCREEN_FRAME_MAGIC;
+        record[1] = 0;  // Raw RGB565
+        record.writeUInt16LE(full ? 1 : 0, 2);
+        record.writeUInt32LE(Number(frame & 0xFFFFFFFFn), 4);
+        record.writeUInt16LE(0, 8);
+        record.writeUInt16LE(y1, 10);
+        record.writeUInt16LE(s.width - 1, 12);
+        record.writeUInt16LE(y2, 14);
+        record.writeUInt32LE(payloadLength, 16);
+        
+        s.lastFrame = frame;
+        broadcastBinaryToUI(record);
+        return;
+    }
+}
+
 // Send to host
 function sendToHost(message) {
     if (hostClient && hostClient.readyState === WebSocket.OPEN) {
@@ -105,11 +256,6 @@ function handleMessage(ws, clientType, message) {
     if (clientType === 'host') {
         // Messages from host -> broadcast to UI
         switch (message.type) {
-            case 'screen':
-                // Forward screen updates to UI
-                broadcastToUI(message);
-                break;
-                
             case 'motor':
                 // Forward motor telemetry to UI
                 broadcastToUI(message);
@@ -136,6 +282,16 @@ function handleMessage(ws, clientType, message) {
                 broadcastToUI(message);
                 break;
                 
+            case 'tasks':
+                // Forward task CPU and timing statistics to UI
+                broadcastToUI(message);
+                break;
+                
+            case 'screen_shm':
+                // New frame in shared memory; read it here instead of over the socket
+                forwardSharedScreen(message);
+                break;
+                
             default:
                 // Forward unknown messages
                 broadcastToUI(message);